@@ -0,0 +1,244 @@
+#include "AssetLoader.h"
+#include "ToneSynth.h"
+#include <fstream>
+
+namespace {
+    /**
+     * @brief Cache key of each asset (the sounds' are also their file names)
+     */
+    const char* const ASSET_NAMES[] = {
+        "font", "move.wav", "rotate.wav", "drop.wav", "line_clear.wav", "game_over.wav", "level_up.wav"
+    };
+
+    const std::vector<std::string> FONT_PATHS = {
+        "arial.ttf",                    // Current directory
+        "fonts/arial.ttf",              // fonts subdirectory
+        "assets/fonts/arial.ttf",       // assets/fonts subdirectory
+        "/System/Library/Fonts/Arial.ttf",           // macOS system font
+        "/Windows/Fonts/arial.ttf",                  // Windows system font
+        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",  // Linux common font
+        "/usr/share/fonts/TTF/arial.ttf"            // Linux alternative
+    };
+
+    const std::vector<std::string> SOUND_DIRECTORIES = {
+        "",                     // Current directory
+        "sounds/",              // sounds subdirectory
+        "assets/sounds/",       // assets/sounds subdirectory
+        "audio/"                // audio subdirectory
+    };
+}
+
+const char* const AssetLoader::DEFAULT_PACK_PATH = "assets.pak";
+const char* const AssetLoader::DEFAULT_CACHE_PATH = "asset_paths.cache";
+
+/**
+ * Constructor - Map the pack, read the cache and start one worker per asset
+ */
+AssetLoader::AssetLoader(const std::string& packPath, const std::string& cachePath) :
+    cachePath(cachePath),
+    packed(),
+    generated(false),
+    pendingSounds(SOUND_COUNT),
+    pendingAssets(ASSET_COUNT),
+    soundsDone(false)
+{
+    if (!packPath.empty()) {
+        pack.open(packPath);
+    }
+    readCache();
+
+    fontThread = std::thread(&AssetLoader::loadFont, this);
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        soundThreads.emplace_back(&AssetLoader::loadSound, this, i);
+    }
+}
+
+AssetLoader::~AssetLoader() {
+    if (fontThread.joinable()) {
+        fontThread.join();
+    }
+    for (auto& thread : soundThreads) {
+        thread.join();
+    }
+}
+
+bool AssetLoader::waitForFont() {
+    if (fontThread.joinable()) {
+        fontThread.join();
+    }
+    return !resolvedPaths[FONT].empty();
+}
+
+const sf::SoundBuffer& AssetLoader::getSoundBuffer(SoundEffect effect) const {
+    return soundBuffers[static_cast<int>(effect)];
+}
+
+const std::string& AssetLoader::getSoundPath(SoundEffect effect) const {
+    return resolvedPaths[FONT + 1 + static_cast<int>(effect)];
+}
+
+void AssetLoader::loadFont() {
+    bool loaded = loadPacked(FONT, [this](const AssetView& view) {
+        return font.loadFromMemory(view.data, view.size);
+    });
+
+    if (!loaded) {
+        for (const auto& path : candidates(FONT, FONT_PATHS)) {
+            if (font.loadFromFile(path)) {
+                resolvedPaths[FONT] = path;
+                break;
+            }
+        }
+    }
+    finishAsset();
+}
+
+/**
+ * Load one sound; the last sound worker to finish publishes the buffers.
+ * Files are probed for without the lock, so only actual decodes wait for each other
+ */
+void AssetLoader::loadSound(int index) {
+    int asset = FONT + 1 + index;
+    bool loaded = loadPacked(asset, [this, index](const AssetView& view) {
+        std::lock_guard<std::mutex> lock(decodeMutex);
+        return soundBuffers[index].loadFromMemory(view.data, view.size);
+    });
+
+    if (!loaded) {
+        std::vector<std::string> searchPaths;
+        for (const auto& directory : SOUND_DIRECTORIES) {
+            searchPaths.push_back(directory + ASSET_NAMES[asset]);
+        }
+
+        for (const auto& path : candidates(asset, searchPaths)) {
+            if (!std::ifstream(path, std::ios::binary).is_open()) continue;
+
+            std::lock_guard<std::mutex> lock(decodeMutex);
+            if (soundBuffers[index].loadFromFile(path)) {
+                resolvedPaths[asset] = path;
+                break;
+            }
+        }
+    }
+
+    // acq_rel: the last worker sees every other worker's buffer and path
+    if (pendingSounds.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        bool anyLoaded = false;
+        for (int i = 0; i < SOUND_COUNT; i++) {
+            anyLoaded = anyLoaded || !resolvedPaths[FONT + 1 + i].empty();
+        }
+        if (!anyLoaded) {
+            generateSounds();
+        }
+        soundsDone.store(true, std::memory_order_release);
+    }
+    finishAsset();
+}
+
+void AssetLoader::finishAsset() {
+    if (pendingAssets.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        writeCache();
+    }
+}
+
+/**
+ * The view points into the mapping, so nothing is read or copied before load sees it
+ */
+template <typename Load>
+bool AssetLoader::loadPacked(int asset, Load load) {
+    AssetView view;
+    if (!pack.find(ASSET_NAMES[asset], view) || !load(view)) return false;
+
+    resolvedPaths[asset] = pack.getPath() + ":" + ASSET_NAMES[asset];
+    packed[asset] = true;
+    return true;
+}
+
+/**
+ * The cached location first, then the search list without it
+ */
+std::vector<std::string> AssetLoader::candidates(int asset, const std::vector<std::string>& searchPaths) const {
+    std::vector<std::string> paths;
+    const std::string& cached = cachedPaths[asset];
+    if (!cached.empty()) {
+        paths.push_back(cached);
+    }
+    for (const auto& path : searchPaths) {
+        if (path != cached) {
+            paths.push_back(path);
+        }
+    }
+    return paths;
+}
+
+/**
+ * One "name=path" line per asset that was found; unknown names are ignored
+ */
+void AssetLoader::readCache() {
+    if (cachePath.empty()) return;
+
+    std::ifstream file(cachePath);
+    std::string line;
+    while (std::getline(file, line)) {
+        size_t separator = line.find('=');
+        if (separator == std::string::npos) continue;
+
+        std::string name = line.substr(0, separator);
+        for (int asset = 0; asset < ASSET_COUNT; asset++) {
+            if (name == ASSET_NAMES[asset]) {
+                cachedPaths[asset] = line.substr(separator + 1);
+            }
+        }
+    }
+}
+
+/**
+ * Rewrite the cache only if a location changed, so a normal launch writes nothing;
+ * packed assets are never probed for, so they have no entry
+ */
+void AssetLoader::writeCache() const {
+    if (cachePath.empty()) return;
+
+    std::string entries[ASSET_COUNT];
+    bool changed = false;
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        if (!packed[asset]) {
+            entries[asset] = resolvedPaths[asset];
+        }
+        changed = changed || entries[asset] != cachedPaths[asset];
+    }
+    if (!changed) return;
+
+    std::ofstream file(cachePath);
+    for (int asset = 0; asset < ASSET_COUNT; asset++) {
+        if (!entries[asset].empty()) {
+            file << ASSET_NAMES[asset] << '=' << entries[asset] << '\n';
+        }
+    }
+}
+
+/**
+ * Render each effect with the vectorised tone kernel
+ */
+void AssetLoader::generateSounds() {
+    const unsigned SAMPLE_RATE = 44100;
+
+    // Per SoundEffect: length, amplitude, decay, partials, pitch glide down, pitch glide up
+    const ToneSpec TONES[SOUND_COUNT] = {
+        { 0.25f, 3000.0f, 10.0f, 1, { 800.0f }, 0.0f, 0.0f },                   // Move: short beep
+        { 0.25f, 3000.0f,  8.0f, 1, { 1200.0f }, 0.0f, 0.0f },                  // Rotate: higher pitch beep
+        { 0.25f, 5000.0f, 15.0f, 1, { 200.0f }, 0.0f, 0.0f },                   // Drop: lower thud
+        { 0.5f,  4000.0f,  3.0f, 3, { 523.25f, 659.25f, 783.99f }, 0.0f, 0.0f }, // Line clear: C5-E5-G5 chime
+        { 1.0f,  4000.0f,  2.0f, 1, { 440.0f }, 2.0f, 0.0f },                   // Game over: descending tone
+        { 0.5f,  4000.0f,  2.0f, 1, { 440.0f }, 0.0f, 880.0f }                  // Level up: ascending chime
+    };
+
+    ToneSynth synth;
+    std::vector<int16_t> samples;
+    for (int i = 0; i < SOUND_COUNT; i++) {
+        synth.render(TONES[i], SAMPLE_RATE, samples);
+        soundBuffers[i].loadFromSamples(samples.data(), samples.size(), 1, SAMPLE_RATE);
+    }
+
+    generated = true;
+}
@@ -0,0 +1,171 @@
+#pragma once
+
+#include <SFML/Graphics/Font.hpp>
+#include <SFML/Audio/SoundBuffer.hpp>
+#include "AssetPack.h"
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Sound effects the game plays
+ */
+enum class SoundEffect {
+    Move,       ///< Piece moved
+    Rotate,     ///< Piece rotated
+    Drop,       ///< Piece landed
+    LineClear,  ///< Lines cleared
+    GameOver,   ///< Game over
+    LevelUp     ///< Level increased
+};
+
+/**
+ * @brief Background loader for the font and sound effects
+ *
+ * Assets come from a memory-mapped AssetPack when one is present: the font
+ * and the sounds are loaded straight from views into the mapping, with one
+ * file open and no probing. Anything the pack doesn't hold is looked for as
+ * a loose file instead.
+ *
+ * Each asset is probed for and loaded on its own worker thread as soon as
+ * the loader is constructed, so slow file system lookups overlap each other
+ * and the window's creation. The font is needed to lay out the first frame
+ * and can be waited for on its own; the sounds arrive later and the game
+ * polls soundsReady() to attach them once they have all finished loading.
+ * If no sound file is found at all, simple effects are synthesised instead.
+ *
+ * SFML's sound decoding is not thread safe: the first decode registers the
+ * file readers in a shared static list, and failures are written to
+ * sf::err(). The sound workers therefore only probe for files in parallel
+ * and take turns decoding.
+ *
+ * Where each loose asset was found is written to a small cache file when loading
+ * ends. Later launches try the cached location first and only fall back to
+ * probing the search directories if it no longer loads. Deleting the cache
+ * file is always safe.
+ */
+class AssetLoader {
+public:
+    static const int SOUND_COUNT = 6;           ///< Number of SoundEffect values
+    static const char* const DEFAULT_PACK_PATH;     ///< Asset pack used when none is given
+    static const char* const DEFAULT_CACHE_PATH;    ///< Cache file used when none is given
+
+    /**
+     * @brief Map the asset pack, read the path cache and start loading every asset
+     *
+     * @param packPath Asset pack to load from if it exists (empty = loose files only)
+     * @param cachePath File remembering where each loose asset was found (empty = no cache)
+     */
+    explicit AssetLoader(const std::string& packPath = DEFAULT_PACK_PATH, const std::string& cachePath = DEFAULT_CACHE_PATH);
+
+    /**
+     * @brief Wait for the workers still running
+     */
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    /**
+     * @brief Block until the font has loaded or failed to (call from one thread only)
+     *
+     * @return true if a font file was loaded
+     */
+    bool waitForFont();
+
+    /**
+     * @brief The font (only valid after waitForFont)
+     */
+    const sf::Font& getFont() const { return font; }
+
+    /**
+     * @brief Whether every sound buffer is final (loaded, synthesised or missing)
+     */
+    bool soundsReady() const { return soundsDone.load(std::memory_order_acquire); }
+
+    /**
+     * @brief A sound buffer (only valid once soundsReady returns true)
+     *
+     * A sound that wasn't found is an empty buffer.
+     */
+    const sf::SoundBuffer& getSoundBuffer(SoundEffect effect) const;
+
+    /**
+     * @brief Where a sound was loaded from, "pack:name" for packed ones (empty if it wasn't; valid once soundsReady)
+     */
+    const std::string& getSoundPath(SoundEffect effect) const;
+
+    /**
+     * @brief Where the font was loaded from (empty if it wasn't; valid after waitForFont)
+     */
+    const std::string& getFontPath() const { return resolvedPaths[FONT]; }
+
+    /**
+     * @brief Whether the sounds were synthesised because no sound file was found
+     */
+    bool soundsGenerated() const { return generated; }
+
+private:
+    static const int FONT = 0;                  ///< Asset index of the font; sounds follow it
+    static const int ASSET_COUNT = SOUND_COUNT + 1;
+
+    std::string cachePath;                      ///< Path cache file (empty = no cache)
+    std::string cachedPaths[ASSET_COUNT];       ///< Locations read from the cache (empty = unknown)
+    std::string resolvedPaths[ASSET_COUNT];     ///< Locations found this run, written by each asset's worker
+    bool packed[ASSET_COUNT];                   ///< Whether each asset came from the pack, written by its worker
+
+    AssetPack pack;                             ///< Mapped asset pack (outlives the font, which reads from it)
+    sf::Font font;                              ///< The UI font
+    sf::SoundBuffer soundBuffers[SOUND_COUNT];  ///< Sound effects, per SoundEffect
+    bool generated;                             ///< Sounds were synthesised
+
+    std::thread fontThread;                     ///< Worker loading the font (joined by waitForFont)
+    std::vector<std::thread> soundThreads;      ///< One worker per sound effect
+    std::atomic<int> pendingSounds;             ///< Sound workers not finished yet
+    std::atomic<int> pendingAssets;             ///< Workers of any kind not finished yet
+    std::atomic<bool> soundsDone;               ///< Set by the last sound worker once the buffers are final
+    std::mutex decodeMutex;                     ///< Held around every SFML sound decode
+
+    /**
+     * @brief Font worker: try the pack, then the cached path, then the search list
+     */
+    void loadFont();
+
+    /**
+     * @brief Sound worker: try the pack, then the cached path, then each search directory
+     *
+     * The last sound worker to finish synthesises the effects if none loaded.
+     */
+    void loadSound(int index);
+
+    /**
+     * @brief Count a worker as finished; the last one saves the cache
+     */
+    void finishAsset();
+
+    /**
+     * @brief Find an asset in the pack and hand its view to load
+     *
+     * @return true if the pack holds the asset and load accepted it
+     */
+    template <typename Load>
+    bool loadPacked(int asset, Load load);
+
+    /**
+     * @brief Candidate locations for a loose asset, the cached one first
+     */
+    std::vector<std::string> candidates(int asset, const std::vector<std::string>& searchPaths) const;
+
+    void readCache();
+    void writeCache() const;
+
+    /**
+     * @brief Synthesise simple sound effects when no sound file could be loaded
+     *
+     * This ensures the game has some audio feedback even without external files.
+     * Runs on a sound worker, so it never holds up startup.
+     */
+    void generateSounds();
+};
@@ -0,0 +1,230 @@
+#include "AssetPack.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char MAGIC[4] = { 'T', 'P', 'A', 'K' };
+    const size_t HEADER_SIZE = 9;               ///< Magic, version and entry count
+
+    void writeUint32(std::vector<uint8_t>& out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out.push_back(static_cast<uint8_t>(value >> (i * 8)));
+        }
+    }
+
+    uint32_t readUint32(const uint8_t* in) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= static_cast<uint32_t>(in[i]) << (i * 8);
+        }
+        return value;
+    }
+
+    /**
+     * Map a whole file read-only; the file itself is closed again right away
+     */
+    const uint8_t* mapFile(const std::string& path, size_t& size) {
+#ifdef _WIN32
+        HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+        LARGE_INTEGER fileSize;
+        const void* view = nullptr;
+        if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+            HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (mapping) {
+                view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                CloseHandle(mapping);  // The view keeps the mapping alive
+            }
+        }
+        CloseHandle(file);
+
+        size = view ? static_cast<size_t>(fileSize.QuadPart) : 0;
+        return static_cast<const uint8_t*>(view);
+#else
+        int file = ::open(path.c_str(), O_RDONLY);
+        if (file < 0) return nullptr;
+
+        struct stat info;
+        void* view = MAP_FAILED;
+        if (fstat(file, &info) == 0 && info.st_size > 0) {
+            view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+        }
+        ::close(file);  // The mapping keeps the file alive
+
+        if (view == MAP_FAILED) return nullptr;
+        size = static_cast<size_t>(info.st_size);
+        return static_cast<const uint8_t*>(view);
+#endif
+    }
+
+    void unmapFile(const uint8_t* base, size_t size) {
+#ifdef _WIN32
+        (void)size;
+        UnmapViewOfFile(base);
+#else
+        munmap(const_cast<uint8_t*>(base), size);
+#endif
+    }
+}
+
+const uint8_t AssetPack::FORMAT_VERSION;
+
+/**
+ * Constructor - Start closed
+ */
+AssetPack::AssetPack() :
+    base(nullptr),
+    mappedSize(0)
+{
+}
+
+AssetPack::~AssetPack() {
+    close();
+}
+
+/**
+ * Map the archive and read its index
+ */
+bool AssetPack::open(const std::string& archivePath) {
+    close();
+
+    base = mapFile(archivePath, mappedSize);
+    if (!base) return false;
+
+    path = archivePath;
+    if (!readIndex()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close() {
+    if (base) {
+        unmapFile(base, mappedSize);
+    }
+    base = nullptr;
+    mappedSize = 0;
+    path.clear();
+    entries.clear();
+}
+
+/**
+ * Linear search: a pack holds a handful of files
+ */
+bool AssetPack::find(const std::string& name, AssetView& view) const {
+    for (const Entry& entry : entries) {
+        if (entry.name == name) {
+            view.data = base + entry.offset;
+            view.size = entry.size;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Decode the index, rejecting anything that points outside the mapping
+ */
+bool AssetPack::readIndex() {
+    if (mappedSize < HEADER_SIZE || !std::equal(MAGIC, MAGIC + 4, base) || base[4] != FORMAT_VERSION) {
+        return false;
+    }
+
+    uint32_t count = readUint32(base + 5);
+    size_t pos = HEADER_SIZE;
+    std::vector<Entry> newEntries;
+    newEntries.reserve(std::min<size_t>(count, mappedSize / 9));  // An entry takes at least 9 bytes
+
+    for (uint32_t i = 0; i < count; i++) {
+        if (pos + 1 > mappedSize) return false;
+        size_t nameLength = base[pos++];
+        if (pos + nameLength + 8 > mappedSize) return false;
+
+        Entry entry;
+        entry.name.assign(reinterpret_cast<const char*>(base + pos), nameLength);
+        pos += nameLength;
+        entry.offset = readUint32(base + pos);
+        entry.size = readUint32(base + pos + 4);
+        pos += 8;
+
+        if (entry.offset > mappedSize || entry.size > mappedSize - entry.offset) return false;
+        newEntries.push_back(entry);
+    }
+
+    entries.swap(newEntries);
+    return true;
+}
+
+/**
+ * Read every source, lay out the index and the aligned contents, write it in one go
+ */
+bool AssetPack::build(const std::string& archivePath, const std::vector<PackSource>& sources, std::string& error) {
+    std::vector<std::vector<uint8_t>> contents;
+    size_t indexSize = HEADER_SIZE;
+    for (const PackSource& source : sources) {
+        if (source.name.empty() || source.name.size() > 255) {
+            error = "name must be 1 to 255 characters: " + source.name;
+            return false;
+        }
+
+        std::ifstream file(source.path, std::ios::binary);
+        if (!file) {
+            error = "could not read " + source.path;
+            return false;
+        }
+        contents.emplace_back(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        indexSize += 1 + source.name.size() + 8;
+    }
+
+    std::vector<uint8_t> out(MAGIC, MAGIC + 4);
+    out.push_back(FORMAT_VERSION);
+    writeUint32(out, static_cast<uint32_t>(sources.size()));
+
+    size_t offset = indexSize;
+    std::vector<size_t> offsets;
+    for (size_t i = 0; i < sources.size(); i++) {
+        offset = (offset + DATA_ALIGNMENT - 1) / DATA_ALIGNMENT * DATA_ALIGNMENT;
+        offsets.push_back(offset);
+
+        out.push_back(static_cast<uint8_t>(sources[i].name.size()));
+        out.insert(out.end(), sources[i].name.begin(), sources[i].name.end());
+        writeUint32(out, static_cast<uint32_t>(offset));
+        writeUint32(out, static_cast<uint32_t>(contents[i].size()));
+        offset += contents[i].size();
+    }
+    if (offset > UINT32_MAX) {
+        error = "archive would exceed 4 GB";
+        return false;
+    }
+
+    for (size_t i = 0; i < sources.size(); i++) {
+        out.resize(offsets[i], 0);
+        out.insert(out.end(), contents[i].begin(), contents[i].end());
+    }
+
+    std::ofstream file(archivePath, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(out.data()), out.size())) {
+        error = "could not write " + archivePath;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief A read-only view of one file stored in an AssetPack
+ */
+struct AssetView {
+    const void* data;                           ///< First byte, inside the pack's mapping
+    size_t size;                                ///< Length in bytes
+};
+
+/**
+ * @brief A file to put into an archive with AssetPack::build
+ */
+struct PackSource {
+    std::string name;                           ///< Name the file is looked up by
+    std::string path;                           ///< File to read
+};
+
+/**
+ * @brief Single-file archive of game assets, memory-mapped for reading
+ *
+ * Layout (integers little-endian):
+ *   "TPAK", version byte, u32 entry count,
+ *   per entry: u8 name length, name bytes, u32 offset, u32 size,
+ *   then the file contents, each starting on a DATA_ALIGNMENT boundary.
+ *
+ * open() maps the whole archive with one file open and reads the small
+ * index; find() then hands out views straight into the mapping, so assets
+ * can be loaded with loadFromMemory / openFromMemory without reading or
+ * copying the file first. Views stay valid until the pack is closed or
+ * destroyed.
+ */
+class AssetPack {
+public:
+    static const uint8_t FORMAT_VERSION = 1;    ///< Bumped on incompatible format changes
+    static const size_t DATA_ALIGNMENT = 16;    ///< Alignment of every file's contents in the archive
+
+    AssetPack();
+    ~AssetPack();
+
+    AssetPack(const AssetPack&) = delete;
+    AssetPack& operator=(const AssetPack&) = delete;
+
+    /**
+     * @brief Map an archive and read its index
+     *
+     * @return false if the file is missing or not a valid archive (the pack is then closed)
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Unmap the archive; every view handed out becomes invalid
+     */
+    void close();
+
+    bool isOpen() const { return base != nullptr; }
+
+    /**
+     * @brief Look up a file by name
+     *
+     * @param name Name given when the archive was built
+     * @param view Receives the file's contents on success
+     * @return false if the pack is closed or has no such file
+     */
+    bool find(const std::string& name, AssetView& view) const;
+
+    const std::string& getPath() const { return path; }
+    size_t getEntryCount() const { return entries.size(); }
+
+    /**
+     * @brief Write an archive containing the given files (the packing tool)
+     *
+     * @param archivePath Archive to create or overwrite
+     * @param sources Files to store, in order
+     * @param error Receives a description of the problem on failure
+     * @return false if a file could not be read, a name is too long or the archive could not be written
+     */
+    static bool build(const std::string& archivePath, const std::vector<PackSource>& sources, std::string& error);
+
+private:
+    /**
+     * @brief Index entry of one stored file
+     */
+    struct Entry {
+        std::string name;                       ///< Lookup name
+        uint32_t offset;                        ///< Start of the contents from the beginning of the archive
+        uint32_t size;                          ///< Length of the contents
+    };
+
+    std::string path;                           ///< Archive that is open (empty when closed)
+    const uint8_t* base;                        ///< Start of the mapping (null when closed)
+    size_t mappedSize;                          ///< Length of the mapping
+    std::vector<Entry> entries;                 ///< The archive's index
+
+    /**
+     * @brief Parse and bounds-check the index of the mapped archive
+     */
+    bool readIndex();
+};
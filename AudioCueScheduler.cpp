@@ -0,0 +1,52 @@
+#include "AudioCueScheduler.h"
+
+/**
+ * Constructor - Start with an empty queue
+ */
+AudioCueScheduler::AudioCueScheduler() :
+    cues(),
+    cueCount(0)
+{
+}
+
+/**
+ * Add a cue that fires after the given delay
+ */
+bool AudioCueScheduler::schedule(SoundEffect effect, sf::Time delay) {
+    if (cueCount >= MAX_CUES) {
+        return false;
+    }
+
+    cues[cueCount].effect = effect;
+    cues[cueCount].due = clock.getElapsedTime() + delay;
+    cueCount++;
+    return true;
+}
+
+/**
+ * Play and remove every cue that is due
+ */
+void AudioCueScheduler::update(SoundMixer& mixer) {
+    if (cueCount == 0) return;
+
+    sf::Time now = clock.getElapsedTime();
+    for (int i = 0; i < cueCount; ) {
+        if (cues[i].due <= now) {
+            mixer.play(cues[i].effect);
+
+            // Order doesn't matter, so fill the hole with the last cue
+            cues[i] = cues[cueCount - 1];
+            cueCount--;
+        }
+        else {
+            i++;
+        }
+    }
+}
+
+/**
+ * Forget all pending cues
+ */
+void AudioCueScheduler::clear() {
+    cueCount = 0;
+}
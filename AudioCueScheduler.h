@@ -0,0 +1,55 @@
+#pragma once
+
+#include "SoundMixer.h"
+#include <SFML/System/Clock.hpp>
+
+/**
+ * @brief Non-blocking scheduler for delayed sound effects
+ *
+ * Game logic enqueues "play this effect after a delay" and the game loop
+ * calls update() every step to start the cues that are due, so a delayed
+ * effect never stalls input, gravity or rendering. Cues are stored in a
+ * fixed-size array; scheduling never allocates.
+ */
+class AudioCueScheduler {
+public:
+    static const int MAX_CUES = 16;             ///< Maximum number of pending cues
+
+    AudioCueScheduler();
+
+    /**
+     * @brief Schedule an effect to start after a delay
+     *
+     * @param effect The effect to play
+     * @param delay Time from now until the effect should start
+     * @return false if the queue is full and the cue was dropped
+     */
+    bool schedule(SoundEffect effect, sf::Time delay);
+
+    /**
+     * @brief Start every cue whose time has come
+     *
+     * Should be called once per step from the game loop.
+     *
+     * @param mixer Mixer the effects are played on
+     */
+    void update(SoundMixer& mixer);
+
+    /**
+     * @brief Drop all pending cues without playing them
+     */
+    void clear();
+
+private:
+    /**
+     * @brief An effect waiting to be played
+     */
+    struct Cue {
+        SoundEffect effect;                     ///< Effect to start
+        sf::Time due;                           ///< Scheduler time at which to start it
+    };
+
+    sf::Clock clock;                            ///< Time base for due times
+    Cue cues[MAX_CUES];                         ///< Pending cues (unordered)
+    int cueCount;                               ///< Number of valid entries in cues
+};
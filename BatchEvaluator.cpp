@@ -0,0 +1,364 @@
+#include "BatchEvaluator.h"
+#include <bitset>
+#include <cstring>
+#include <algorithm>
+#include <cstdlib>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TETRIS_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define TETRIS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+/**
+ * Constructor - Start with an empty batch; lanes are zeroed so that the
+ * padding lanes of a partial vector never hold uninitialised rows
+ */
+BoardBatch::BoardBatch() :
+    count(0)
+{
+    std::memset(rows, 0, sizeof(rows));
+    std::memset(linesCleared, 0, sizeof(linesCleared));
+}
+
+/**
+ * Scatter one board's rows into the next lane
+ */
+int BoardBatch::add(const uint16_t boardRows[TetrisEngine::BOARD_HEIGHT], int lines) {
+    int lane = count++;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; y++) {
+        rows[y][lane] = boardRows[y];
+    }
+    linesCleared[lane] = static_cast<int16_t>(lines);
+    return lane;
+}
+
+/**
+ * Gather one lane's features
+ */
+BoardFeatures FeatureBatch::get(const BoardBatch& batch, int lane) const {
+    BoardFeatures features;
+    features.aggregateHeight = aggregateHeight[lane];
+    features.linesCleared = batch.linesCleared[lane];
+    features.holes = holes[lane];
+    features.bumpiness = bumpiness[lane];
+    features.wells = wells[lane];
+    features.maxHeight = maxHeight[lane];
+    return features;
+}
+
+namespace {
+    const int HEIGHT_BITS = 5;                  // Bit planes needed for heights up to BOARD_HEIGHT
+
+    static_assert(TetrisEngine::BOARD_HEIGHT < (1 << HEIGHT_BITS), "heights must fit in the bit planes");
+    static_assert(TetrisEngine::BOARD_WIDTH <= 16, "a row must fit in a 16-bit lane");
+
+    /**
+     * Score lanes with the same operation order as BatchEvaluator::score,
+     * so every backend rounds identically
+     */
+    template <typename Ops>
+    void storeScores(float* out, typename Ops::Vec aggregateHeight, typename Ops::Vec lines,
+                     typename Ops::Vec holes, typename Ops::Vec bumpiness, typename Ops::Vec wells,
+                     const HeuristicWeights& weights) {
+        for (int half = 0; half < 2; half++) {
+            auto sum = Ops::mul(Ops::toFloat(aggregateHeight, half), weights.aggregateHeight);
+            sum = Ops::addFloat(sum, Ops::mul(Ops::toFloat(lines, half), weights.linesCleared));
+            sum = Ops::addFloat(sum, Ops::mul(Ops::toFloat(holes, half), weights.holes));
+            sum = Ops::addFloat(sum, Ops::mul(Ops::toFloat(bumpiness, half), weights.bumpiness));
+            sum = Ops::addFloat(sum, Ops::mul(Ops::toFloat(wells, half), weights.wells));
+            Ops::storeFloat(out + half * Ops::WIDTH / 2, sum);
+        }
+    }
+
+    /**
+     * Evaluate a batch Ops::WIDTH boards at a time, one board per 16-bit lane
+     */
+    template <typename Ops>
+    void evaluateLanes(const BoardBatch& batch, const HeuristicWeights& weights, FeatureBatch& out) {
+        using Vec = typename Ops::Vec;
+        const int width = TetrisEngine::BOARD_WIDTH;
+        const int height = TetrisEngine::BOARD_HEIGHT;
+
+        const Vec zero = Ops::set(0);
+        const Vec fullHeight = Ops::set(height);
+        const Vec pairMask = Ops::set(0x5555);
+        const Vec nibbleMask = Ops::set(0x3333);
+        const Vec byteMask = Ops::set(0x0f0f);
+        const Vec lowByte = Ops::set(0x00ff);
+
+        for (int lane = 0; lane < batch.count; lane += Ops::WIDTH) {
+            // Walk down the rows. A column's height is fixed by the row its
+            // first block appears in, so OR the newly covered columns into
+            // the bit planes of that row's height. Filled cells are counted
+            // per byte with a SWAR popcount.
+            Vec covered = zero;
+            Vec cells = zero;
+            Vec planes[HEIGHT_BITS];
+            for (int k = 0; k < HEIGHT_BITS; k++) planes[k] = zero;
+
+            for (int y = 0; y < height; y++) {
+                Vec row = Ops::load(&batch.rows[y][lane]);
+                Vec tops = Ops::andNot(covered, row);
+                covered = Ops::bitOr(covered, row);
+
+                for (int k = 0; k < HEIGHT_BITS; k++) {
+                    if ((height - y) & (1 << k)) planes[k] = Ops::bitOr(planes[k], tops);
+                }
+
+                Vec count = Ops::sub(row, Ops::bitAnd(Ops::shiftRight(row, 1), pairMask));
+                count = Ops::add(Ops::bitAnd(count, nibbleMask), Ops::bitAnd(Ops::shiftRight(count, 2), nibbleMask));
+                count = Ops::bitAnd(Ops::add(count, Ops::shiftRight(count, 4)), byteMask);
+                cells = Ops::add(cells, count);
+            }
+            cells = Ops::add(Ops::bitAnd(cells, lowByte), Ops::shiftRight(cells, 8));
+
+            // Transpose the bit planes back into one height per column
+            Vec heights[width];
+            Vec aggregateHeight = zero;
+            Vec maxHeight = zero;
+            for (int x = 0; x < width; x++) {
+                Vec columnHeight = zero;
+                for (int k = 0; k < HEIGHT_BITS; k++) {
+                    Vec bit = x >= k ? Ops::shiftRight(planes[k], x - k) : Ops::shiftLeft(planes[k], k - x);
+                    columnHeight = Ops::bitOr(columnHeight, Ops::bitAnd(bit, Ops::set(1 << k)));
+                }
+                heights[x] = columnHeight;
+                aggregateHeight = Ops::add(aggregateHeight, columnHeight);
+                maxHeight = Ops::max(maxHeight, columnHeight);
+            }
+
+            // Every covered cell is either filled or a hole
+            Vec holes = Ops::sub(aggregateHeight, cells);
+
+            Vec bumpiness = zero;
+            Vec wells = zero;
+            for (int x = 0; x < width; x++) {
+                if (x + 1 < width) {
+                    Vec difference = Ops::sub(heights[x], heights[x + 1]);
+                    bumpiness = Ops::add(bumpiness, Ops::max(difference, Ops::sub(zero, difference)));
+                }
+
+                // Walls count as infinitely high neighbours
+                Vec left = x > 0 ? heights[x - 1] : fullHeight;
+                Vec right = x + 1 < width ? heights[x + 1] : fullHeight;
+                Vec depth = Ops::sub(Ops::min(left, right), heights[x]);
+                wells = Ops::add(wells, Ops::max(depth, zero));
+            }
+
+            Ops::store(&out.aggregateHeight[lane], aggregateHeight);
+            Ops::store(&out.holes[lane], holes);
+            Ops::store(&out.bumpiness[lane], bumpiness);
+            Ops::store(&out.wells[lane], wells);
+            Ops::store(&out.maxHeight[lane], maxHeight);
+
+            Vec lines = Ops::load(&batch.linesCleared[lane]);
+            storeScores<Ops>(&out.score[lane], aggregateHeight, lines, holes, bumpiness, wells, weights);
+        }
+    }
+
+#ifdef TETRIS_HAVE_SSE2
+    /**
+     * 8 x 16-bit lanes in SSE2 registers
+     */
+    struct Sse2Ops {
+        using Vec = __m128i;
+        using FloatVec = __m128;
+        static const int WIDTH = 8;
+
+        static Vec load(const void* p) { return _mm_load_si128(static_cast<const __m128i*>(p)); }
+        static void store(void* p, Vec v) { _mm_store_si128(static_cast<__m128i*>(p), v); }
+        static Vec set(int value) { return _mm_set1_epi16(static_cast<short>(value)); }
+        static Vec bitOr(Vec a, Vec b) { return _mm_or_si128(a, b); }
+        static Vec bitAnd(Vec a, Vec b) { return _mm_and_si128(a, b); }
+        static Vec andNot(Vec a, Vec b) { return _mm_andnot_si128(a, b); }
+        static Vec add(Vec a, Vec b) { return _mm_add_epi16(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm_sub_epi16(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm_min_epi16(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm_max_epi16(a, b); }
+        static Vec shiftRight(Vec v, int bits) { return _mm_srl_epi16(v, _mm_cvtsi32_si128(bits)); }
+        static Vec shiftLeft(Vec v, int bits) { return _mm_sll_epi16(v, _mm_cvtsi32_si128(bits)); }
+
+        // Features are never negative, so zero-extending to 32 bits is safe
+        static FloatVec toFloat(Vec v, int half) {
+            Vec wide = half == 0 ? _mm_unpacklo_epi16(v, _mm_setzero_si128()) : _mm_unpackhi_epi16(v, _mm_setzero_si128());
+            return _mm_cvtepi32_ps(wide);
+        }
+        static FloatVec mul(FloatVec v, float weight) { return _mm_mul_ps(v, _mm_set1_ps(weight)); }
+        static FloatVec addFloat(FloatVec a, FloatVec b) { return _mm_add_ps(a, b); }
+        static void storeFloat(float* p, FloatVec v) { _mm_store_ps(p, v); }
+    };
+#endif
+
+#ifdef TETRIS_HAVE_AVX2
+    /**
+     * 16 x 16-bit lanes in AVX2 registers
+     */
+    struct Avx2Ops {
+        using Vec = __m256i;
+        using FloatVec = __m256;
+        static const int WIDTH = 16;
+
+        static Vec load(const void* p) { return _mm256_load_si256(static_cast<const __m256i*>(p)); }
+        static void store(void* p, Vec v) { _mm256_store_si256(static_cast<__m256i*>(p), v); }
+        static Vec set(int value) { return _mm256_set1_epi16(static_cast<short>(value)); }
+        static Vec bitOr(Vec a, Vec b) { return _mm256_or_si256(a, b); }
+        static Vec bitAnd(Vec a, Vec b) { return _mm256_and_si256(a, b); }
+        static Vec andNot(Vec a, Vec b) { return _mm256_andnot_si256(a, b); }
+        static Vec add(Vec a, Vec b) { return _mm256_add_epi16(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm256_sub_epi16(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm256_min_epi16(a, b); }
+        static Vec max(Vec a, Vec b) { return _mm256_max_epi16(a, b); }
+        static Vec shiftRight(Vec v, int bits) { return _mm256_srl_epi16(v, _mm_cvtsi32_si128(bits)); }
+        static Vec shiftLeft(Vec v, int bits) { return _mm256_sll_epi16(v, _mm_cvtsi32_si128(bits)); }
+
+        // cvtepu16 widens in lane order, unlike the in-lane AVX2 unpacks
+        static FloatVec toFloat(Vec v, int half) {
+            __m128i part = half == 0 ? _mm256_castsi256_si128(v) : _mm256_extracti128_si256(v, 1);
+            return _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(part));
+        }
+        static FloatVec mul(FloatVec v, float weight) { return _mm256_mul_ps(v, _mm256_set1_ps(weight)); }
+        static FloatVec addFloat(FloatVec a, FloatVec b) { return _mm256_add_ps(a, b); }
+        static void storeFloat(float* p, FloatVec v) { _mm256_store_ps(p, v); }
+    };
+#endif
+
+    /**
+     * Reference path: gather each lane and evaluate it on its own
+     */
+    void evaluateScalar(const BoardBatch& batch, const HeuristicWeights& weights, FeatureBatch& out) {
+        uint16_t rows[TetrisEngine::BOARD_HEIGHT];
+        for (int lane = 0; lane < batch.count; lane++) {
+            for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; y++) {
+                rows[y] = batch.rows[y][lane];
+            }
+
+            BoardFeatures features = BatchEvaluator::computeFeatures(rows, batch.linesCleared[lane]);
+            out.aggregateHeight[lane] = static_cast<int16_t>(features.aggregateHeight);
+            out.holes[lane] = static_cast<int16_t>(features.holes);
+            out.bumpiness[lane] = static_cast<int16_t>(features.bumpiness);
+            out.wells[lane] = static_cast<int16_t>(features.wells);
+            out.maxHeight[lane] = static_cast<int16_t>(features.maxHeight);
+            out.score[lane] = BatchEvaluator::score(features, weights);
+        }
+    }
+}
+
+/**
+ * Constructor - Use the requested backend if it was compiled in
+ */
+BatchEvaluator::BatchEvaluator(EvalBackend backend) :
+    backend(isAvailable(backend) ? backend : bestBackend())
+{
+}
+
+/**
+ * Dispatch to the selected backend
+ */
+void BatchEvaluator::evaluate(const BoardBatch& batch, const HeuristicWeights& weights, FeatureBatch& out) const {
+    switch (backend) {
+#ifdef TETRIS_HAVE_AVX2
+    case EvalBackend::AVX2:
+        evaluateLanes<Avx2Ops>(batch, weights, out);
+        break;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+    case EvalBackend::SSE2:
+        evaluateLanes<Sse2Ops>(batch, weights, out);
+        break;
+#endif
+    default:
+        evaluateScalar(batch, weights, out);
+        break;
+    }
+}
+
+/**
+ * Report whether a backend was compiled in
+ */
+bool BatchEvaluator::isAvailable(EvalBackend backend) {
+    switch (backend) {
+#ifdef TETRIS_HAVE_AVX2
+    case EvalBackend::AVX2: return true;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+    case EvalBackend::SSE2: return true;
+#endif
+    case EvalBackend::Scalar: return true;
+    default: return false;
+    }
+}
+
+/**
+ * Pick the widest backend compiled in
+ */
+EvalBackend BatchEvaluator::bestBackend() {
+    if (isAvailable(EvalBackend::AVX2)) return EvalBackend::AVX2;
+    if (isAvailable(EvalBackend::SSE2)) return EvalBackend::SSE2;
+    return EvalBackend::Scalar;
+}
+
+/**
+ * Backend display names
+ */
+const char* BatchEvaluator::backendName(EvalBackend backend) {
+    switch (backend) {
+    case EvalBackend::SSE2: return "SSE2";
+    case EvalBackend::AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
+
+/**
+ * Compute column heights, holes, bumpiness and wells from the row bitmasks
+ */
+BoardFeatures BatchEvaluator::computeFeatures(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], int linesCleared) {
+    int heights[TetrisEngine::BOARD_WIDTH] = {};
+    BoardFeatures features = {};
+    features.linesCleared = linesCleared;
+
+    // Walk down the rows: a column's height is set by its first filled cell,
+    // and every empty cell in an already covered column is a hole
+    uint16_t covered = 0;
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; y++) {
+        uint16_t newTops = rows[y] & ~covered;
+        while (newTops) {
+            int x = 0;
+            while (!(newTops & (1u << x))) x++;
+            heights[x] = TetrisEngine::BOARD_HEIGHT - y;
+            newTops &= newTops - 1;
+        }
+        covered |= rows[y];
+        features.holes += static_cast<int>(std::bitset<16>(covered & ~rows[y]).count());
+    }
+
+    for (int x = 0; x < TetrisEngine::BOARD_WIDTH; x++) {
+        features.aggregateHeight += heights[x];
+        features.maxHeight = std::max(features.maxHeight, heights[x]);
+        if (x + 1 < TetrisEngine::BOARD_WIDTH) {
+            features.bumpiness += std::abs(heights[x] - heights[x + 1]);
+        }
+
+        // Walls count as infinitely high neighbours
+        int left = x > 0 ? heights[x - 1] : TetrisEngine::BOARD_HEIGHT;
+        int right = x + 1 < TetrisEngine::BOARD_WIDTH ? heights[x + 1] : TetrisEngine::BOARD_HEIGHT;
+        int depth = std::min(left, right) - heights[x];
+        if (depth > 0) features.wells += depth;
+    }
+    return features;
+}
+
+/**
+ * Weighted sum of the features
+ */
+float BatchEvaluator::score(const BoardFeatures& features, const HeuristicWeights& weights) {
+    return weights.aggregateHeight * features.aggregateHeight +
+           weights.linesCleared * features.linesCleared +
+           weights.holes * features.holes +
+           weights.bumpiness * features.bumpiness +
+           weights.wells * features.wells;
+}
@@ -0,0 +1,144 @@
+#pragma once
+
+#include "TetrisEngine.h"
+#include <cstdint>
+
+/**
+ * @brief Weights of the placement heuristic
+ *
+ * The score of a placement is the weighted sum of the features of the board
+ * it leaves behind. Defaults are the well-known weights tuned by genetic
+ * search for 10x20 boards, plus a small penalty for wells.
+ */
+struct HeuristicWeights {
+    float aggregateHeight = -0.510066f;         ///< Sum of column heights
+    float linesCleared = 0.760666f;             ///< Lines cleared by the placement
+    float holes = -0.35663f;                    ///< Empty cells with a filled cell somewhere above
+    float bumpiness = -0.184483f;               ///< Sum of height differences between neighbouring columns
+    float wells = -0.05f;                       ///< Sum of well depths (columns lower than both neighbours)
+};
+
+/**
+ * @brief Board features used by the placement heuristic
+ */
+struct BoardFeatures {
+    int aggregateHeight;                        ///< Sum of column heights
+    int linesCleared;                           ///< Lines cleared by the placement
+    int holes;                                  ///< Covered empty cells
+    int bumpiness;                              ///< Sum of |height difference| of neighbouring columns
+    int wells;                                  ///< Sum of well depths
+    int maxHeight;                              ///< Height of the tallest column
+};
+
+/**
+ * @brief Instruction sets the batch evaluator can run on
+ */
+enum class EvalBackend {
+    Scalar,     ///< One board at a time, portable
+    SSE2,       ///< 8 boards per 128-bit register
+    AVX2        ///< 16 boards per 256-bit register (needs /arch:AVX2 or -mavx2)
+};
+
+/**
+ * @brief Candidate boards packed lane by lane for SIMD evaluation
+ *
+ * Stored structure-of-arrays: rows[y][lane] holds row y of board 'lane', so
+ * loading row y of 8 or 16 consecutive boards is a single aligned load and
+ * every board is processed in its own 16-bit lane.
+ */
+struct BoardBatch {
+    static const int CAPACITY = 64;             ///< Boards per batch (a multiple of every vector width)
+
+    alignas(32) uint16_t rows[TetrisEngine::BOARD_HEIGHT][CAPACITY];  ///< Row bitmasks, one lane per board
+    alignas(32) int16_t linesCleared[CAPACITY]; ///< Lines the placement cleared, per board
+    int count;                                  ///< Boards currently in the batch
+
+    BoardBatch();
+
+    /**
+     * @brief Append a board
+     *
+     * @param boardRows Row bitmasks after the placement and line clear
+     * @param lines Lines the placement cleared
+     * @return Lane the board was stored in
+     */
+    int add(const uint16_t boardRows[TetrisEngine::BOARD_HEIGHT], int lines);
+
+    bool isFull() const { return count == CAPACITY; }
+    void clear() { count = 0; }
+};
+
+/**
+ * @brief Features and scores of a BoardBatch, lane for lane
+ */
+struct FeatureBatch {
+    alignas(32) int16_t aggregateHeight[BoardBatch::CAPACITY];
+    alignas(32) int16_t holes[BoardBatch::CAPACITY];
+    alignas(32) int16_t bumpiness[BoardBatch::CAPACITY];
+    alignas(32) int16_t wells[BoardBatch::CAPACITY];
+    alignas(32) int16_t maxHeight[BoardBatch::CAPACITY];
+    alignas(32) float score[BoardBatch::CAPACITY];     ///< Weighted sum of the features
+
+    /**
+     * @brief Gather one lane back into a BoardFeatures
+     */
+    BoardFeatures get(const BoardBatch& batch, int lane) const;
+};
+
+/**
+ * @brief Computes heuristic features for many candidate boards at once
+ *
+ * The SIMD backends work on the packed rows with the board's own bit
+ * layout: column heights are collected as bit planes while walking down the
+ * rows (a column's height is fixed by the row its first block appears in),
+ * holes fall out as aggregate height minus filled cells, and bumpiness and
+ * wells are plain lane-wise arithmetic on the heights. Every backend
+ * produces exactly the same features and scores.
+ *
+ * The SIMD backends are chosen at compile time from the target instruction
+ * set; the scalar backend is always available.
+ */
+class BatchEvaluator {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param backend Backend to use; falls back to the best available one if not compiled in
+     */
+    explicit BatchEvaluator(EvalBackend backend = bestBackend());
+
+    /**
+     * @brief Compute features and scores for every board in the batch
+     */
+    void evaluate(const BoardBatch& batch, const HeuristicWeights& weights, FeatureBatch& out) const;
+
+    EvalBackend getBackend() const { return backend; }
+
+    /**
+     * @brief Whether a backend was compiled into this build
+     */
+    static bool isAvailable(EvalBackend backend);
+
+    /**
+     * @brief Widest backend compiled into this build
+     */
+    static EvalBackend bestBackend();
+
+    /**
+     * @brief Display name of a backend
+     */
+    static const char* backendName(EvalBackend backend);
+
+    /**
+     * @brief Compute the heuristic features of a single board (reference implementation)
+     */
+    static BoardFeatures computeFeatures(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], int linesCleared);
+
+    /**
+     * @brief Weighted sum of board features
+     */
+    static float score(const BoardFeatures& features, const HeuristicWeights& weights);
+
+private:
+    EvalBackend backend;                        ///< Backend used by evaluate()
+};
@@ -0,0 +1,108 @@
+#include "BoardRenderer.h"
+#include <cstring>
+
+/**
+ * Constructor - Create the quads for every cell; only their colors change afterwards
+ */
+BoardRenderer::BoardRenderer(float blockSize) :
+    blockSize(blockSize),
+    vertices(sf::Quads, (CELL_COUNT + PIECE_BLOCKS) * 4)
+{
+    const float size = blockSize - 1;  // -1 for grid lines
+
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; y++) {
+        for (int x = 0; x < TetrisEngine::BOARD_WIDTH; x++) {
+            sf::Vertex* quad = &vertices[(y * TetrisEngine::BOARD_WIDTH + x) * 4];
+            float left = x * blockSize;
+            float top = y * blockSize;
+
+            quad[0].position = sf::Vector2f(left, top);
+            quad[1].position = sf::Vector2f(left + size, top);
+            quad[2].position = sf::Vector2f(left + size, top + size);
+            quad[3].position = sf::Vector2f(left, top + size);
+
+            // Empty cells are fully transparent so the background shows through
+            for (int i = 0; i < 4; i++) {
+                quad[i].color = sf::Color::Transparent;
+            }
+        }
+    }
+
+    // The piece quads start hidden (vertices default to white)
+    for (int i = CELL_COUNT * 4; i < (CELL_COUNT + PIECE_BLOCKS) * 4; i++) {
+        vertices[i].color = sf::Color::Transparent;
+    }
+
+    std::memset(shownColors, 0, sizeof(shownColors));
+}
+
+/**
+ * Rewrite the colors of the board quads whose cell changed since the last frame
+ */
+void BoardRenderer::update(const GameSnapshot& snapshot, const std::vector<sf::Color>& colors, float fallOffset) {
+    const uint8_t* wanted = &snapshot.cells[0][0];
+
+    // Touch only the quads that actually changed
+    for (int i = 0; i < CELL_COUNT; i++) {
+        if (wanted[i] == shownColors[i]) continue;
+
+        sf::Color color = wanted[i] == 0 ? sf::Color::Transparent : colors[wanted[i]];
+        sf::Vertex* quad = &vertices[i * 4];
+        for (int v = 0; v < 4; v++) {
+            quad[v].color = color;
+        }
+        shownColors[i] = wanted[i];
+    }
+
+    updatePiece(snapshot, colors, fallOffset);
+}
+
+/**
+ * Move the four piece quads onto the falling piece's blocks (hidden after game over
+ * and above the top edge)
+ */
+void BoardRenderer::updatePiece(const GameSnapshot& snapshot, const std::vector<sf::Color>& colors, float fallOffset) {
+    const float size = blockSize - 1;  // -1 for grid lines
+    sf::Vertex* quad = &vertices[CELL_COUNT * 4];
+    int block = 0;
+
+    if (!snapshot.gameOver) {
+        const ActivePiece& piece = snapshot.piece;
+        const PieceShape& shape = PieceTable::shape(piece.type, piece.rotation);
+        const sf::Color color = colors[piece.type + 1];
+
+        for (int py = shape.minY; py <= shape.maxY; py++) {
+            int boardY = piece.y + py;
+            if (boardY < 0) continue;
+
+            for (int px = shape.minX; px <= shape.maxX; px++) {
+                if (!(shape.rows[py] & (1u << px))) continue;
+
+                float left = (piece.x + px) * blockSize;
+                float top = (boardY + fallOffset) * blockSize;
+                quad[0].position = sf::Vector2f(left, top);
+                quad[1].position = sf::Vector2f(left + size, top);
+                quad[2].position = sf::Vector2f(left + size, top + size);
+                quad[3].position = sf::Vector2f(left, top + size);
+                for (int v = 0; v < 4; v++) {
+                    quad[v].color = color;
+                }
+                quad += 4;
+                block++;
+            }
+        }
+    }
+
+    for (; block < PIECE_BLOCKS; block++, quad += 4) {
+        for (int v = 0; v < 4; v++) {
+            quad[v].color = sf::Color::Transparent;
+        }
+    }
+}
+
+/**
+ * Submit every block with one draw call
+ */
+void BoardRenderer::draw(sf::RenderTarget& target, sf::RenderStates states) const {
+    target.draw(vertices, states);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "TetrisEngine.h"
+#include "GameSnapshot.h"
+#include <SFML/Graphics.hpp>
+#include <vector>
+#include <cstdint>
+
+/**
+ * @brief Batched renderer for the board and the falling piece
+ *
+ * Keeps one persistent quad per board cell in a single sf::VertexArray.
+ * Each frame only the quads whose color changed are rewritten. The falling
+ * piece has four quads of its own at the end of the same array, moved every
+ * frame so it can be drawn between rows, and everything is submitted with
+ * one draw call.
+ */
+class BoardRenderer : public sf::Drawable {
+public:
+    /**
+     * @brief Constructor - lays out one quad per board cell
+     *
+     * @param blockSize Size of each block in pixels
+     */
+    explicit BoardRenderer(float blockSize);
+
+    /**
+     * @brief Sync the vertices with a snapshot of the game
+     *
+     * @param snapshot Board and falling piece to show
+     * @param colors Color mapping for each piece type (index 0 is empty)
+     * @param fallOffset Fraction of a row to draw the falling piece below its cell (0 = on the grid)
+     *
+     * The falling piece is drawn over the board unless the game is over.
+     */
+    void update(const GameSnapshot& snapshot, const std::vector<sf::Color>& colors, float fallOffset = 0);
+
+private:
+    static const int CELL_COUNT = TetrisEngine::BOARD_WIDTH * TetrisEngine::BOARD_HEIGHT;
+    static const int PIECE_BLOCKS = 4;          ///< Blocks in a tetromino
+
+    float blockSize;                            ///< Size of each block in pixels
+    sf::VertexArray vertices;                   ///< Four vertices per board cell, then four per falling piece block
+    uint8_t shownColors[CELL_COUNT];            ///< Color index currently written to each board quad
+
+    /**
+     * @brief Place the falling piece's quads
+     */
+    void updatePiece(const GameSnapshot& snapshot, const std::vector<sf::Color>& colors, float fallOffset);
+
+    /**
+     * @brief Draw the whole board in a single call
+     */
+    void draw(sf::RenderTarget& target, sf::RenderStates states) const override;
+};
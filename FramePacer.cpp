@@ -0,0 +1,65 @@
+#include "FramePacer.h"
+#include <SFML/System/Sleep.hpp>
+#include <thread>
+
+namespace {
+    const char* const MODE_NAMES[] = { "vsync", "limit", "uncapped", "on-change" };
+}
+
+/**
+ * Constructor - Derive the frame period from the target rate
+ */
+FramePacer::FramePacer(const PacingSettings& settings) :
+    settings(settings),
+    period(std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / (settings.targetFps > 0 ? settings.targetFps : 60)))),
+    deadline()
+{
+}
+
+/**
+ * Only VSync mode uses the driver; every other mode paces itself (or not at all)
+ */
+void FramePacer::configure(sf::Window& window) const {
+    window.setFramerateLimit(0);
+    window.setVerticalSyncEnabled(settings.mode == PacingMode::VSync);
+}
+
+/**
+ * Coarse sleep to within the spin window of the deadline, then spin the rest
+ */
+void FramePacer::waitForDeadline() {
+    if (settings.mode == PacingMode::VSync || settings.mode == PacingMode::Uncapped) return;
+
+    Clock::time_point now = Clock::now();
+
+    // First frame, or more than a whole frame late: restart the schedule from now
+    if (deadline == Clock::time_point() || now - deadline > period) {
+        deadline = now + period;
+        return;
+    }
+
+    Clock::duration sleepTime = (deadline - now) - std::chrono::microseconds(settings.spinWindowUs);
+    if (sleepTime > Clock::duration::zero()) {
+        // sf::sleep raises the Windows timer resolution to 1 ms for the call
+        sf::sleep(sf::microseconds(std::chrono::duration_cast<std::chrono::microseconds>(sleepTime).count()));
+    }
+    while (Clock::now() < deadline) {
+        std::this_thread::yield();
+    }
+
+    deadline += period;
+}
+
+const char* FramePacer::modeName(PacingMode mode) {
+    return MODE_NAMES[static_cast<int>(mode)];
+}
+
+bool FramePacer::parseMode(const std::string& name, PacingMode& mode) {
+    for (int i = 0; i < static_cast<int>(sizeof(MODE_NAMES) / sizeof(MODE_NAMES[0])); i++) {
+        if (name == MODE_NAMES[i]) {
+            mode = static_cast<PacingMode>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <SFML/Window/Window.hpp>
+#include <chrono>
+#include <string>
+
+/**
+ * @brief How the render loop decides when to present a frame
+ */
+enum class PacingMode {
+    VSync,      ///< Let the driver block in display() until the next vertical blank
+    Limiter,    ///< Own limiter: sleep until just before the deadline, then spin
+    Uncapped,   ///< Present as fast as possible
+    OnChange    ///< Only draw when the game state changed, then pace like Limiter
+};
+
+/**
+ * @brief Frame pacing configuration
+ */
+struct PacingSettings {
+    PacingMode mode = PacingMode::Limiter;      ///< Pacing strategy
+    int targetFps = 60;                         ///< Frame rate for Limiter and OnChange
+    int spinWindowUs = 2000;                    ///< Final stretch before a deadline spent spinning instead of sleeping
+};
+
+/**
+ * @brief Frame rate control for the render loop
+ *
+ * sf::Window::setFramerateLimit sleeps for the whole remainder of a frame,
+ * and an OS sleep can overshoot by a scheduler quantum (about 1 ms at best,
+ * 15.6 ms at worst on Windows), so frame lengths wobble. The Limiter mode
+ * instead sleeps until spinWindowUs before the deadline and busy-waits the
+ * rest, trading a little CPU for accurate frame times. Deadlines advance by
+ * a fixed period rather than from the actual present time, so an early or
+ * late frame doesn't shift the ones after it; after a long stall the
+ * schedule restarts from now instead of rushing to catch up.
+ *
+ * Jitter is measured by FrameProfiler, which sees every frame interval.
+ */
+class FramePacer {
+public:
+    explicit FramePacer(const PacingSettings& settings = PacingSettings());
+
+    /**
+     * @brief Set up the window's own vsync and frame limit for the mode
+     *
+     * Must be called from a thread where the window's context may be activated.
+     */
+    void configure(sf::Window& window) const;
+
+    /**
+     * @brief Wait until the next frame should be presented
+     *
+     * Call right before window.display(). Returns at once in VSync and
+     * Uncapped modes.
+     */
+    void waitForDeadline();
+
+    /**
+     * @brief Whether a frame without new game state can be skipped
+     */
+    bool rendersOnlyOnChange() const { return settings.mode == PacingMode::OnChange; }
+
+    const PacingSettings& getSettings() const { return settings; }
+
+    /**
+     * @brief Short name of the mode, as accepted by parseMode
+     */
+    static const char* modeName(PacingMode mode);
+
+    /**
+     * @brief Parse "vsync", "limit", "uncapped" or "on-change"
+     *
+     * @return false if the name is not a mode
+     */
+    static bool parseMode(const std::string& name, PacingMode& mode);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    PacingSettings settings;                    ///< Mode and timing
+    Clock::duration period;                     ///< Time between deadlines
+    Clock::time_point deadline;                 ///< When the next frame is due (epoch = not started)
+};
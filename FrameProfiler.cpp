@@ -0,0 +1,278 @@
+#include "FrameProfiler.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace {
+    const char* const COLUMN_NAMES[] = {
+        "snapshot", "sync", "render", "present", "total", "jitter", "step", "tick_lateness"
+    };
+
+    /**
+     * @brief Index of the nearest-rank percentile q in count sorted samples
+     */
+    size_t percentileRank(double q, size_t count) {
+        size_t rank = static_cast<size_t>(std::ceil(q * count));
+        return rank > 0 ? rank - 1 : 0;
+    }
+
+    bool endsWith(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() &&
+               text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+}
+
+const int FrameProfiler::WINDOW_FRAMES;
+const int FrameProfiler::WINDOW_STEPS;
+
+/**
+ * Constructor - Preallocate the rolling windows and start the first frame
+ */
+FrameProfiler::FrameProfiler(bool keepLog) :
+    lastMark(Clock::now()),
+    current(),
+    previousTotal(-1),
+    window(WINDOW_FRAMES),
+    windowHead(0),
+    windowFilled(0),
+    frameCount(0),
+    keepLog(keepLog),
+    scratch(std::max(WINDOW_FRAMES, WINDOW_STEPS)),
+    stepStart(Clock::now()),
+    steps(),
+    stepHead(0),
+    stepTail(0),
+    stepWindow(WINDOW_STEPS),
+    stepWindowHead(0),
+    stepWindowFilled(0)
+{
+}
+
+/**
+ * Charge the time since the previous mark to a phase
+ */
+void FrameProfiler::mark(FramePhase phase) {
+    Clock::time_point now = Clock::now();
+    current[static_cast<int>(phase)] += std::chrono::duration<float, std::micro>(now - lastMark).count();
+    lastMark = now;
+}
+
+/**
+ * Push the finished frame into the window (and log) and reset for the next
+ */
+void FrameProfiler::endFrame() {
+    current[TOTAL] = 0;
+    for (int phase = 0; phase < PHASE_COUNT; phase++) {
+        current[TOTAL] += current[phase];
+    }
+    current[JITTER] = previousTotal < 0 ? 0 : std::fabs(current[TOTAL] - previousTotal);
+    previousTotal = current[TOTAL];
+    drainSteps();
+
+    window[windowHead] = current;
+    windowHead = (windowHead + 1) % WINDOW_FRAMES;
+    windowFilled = std::min(windowFilled + 1, WINDOW_FRAMES);
+    if (keepLog) {
+        log.push_back(current);
+    }
+
+    frameCount++;
+    current.fill(0);
+}
+
+void FrameProfiler::beginStep() {
+    stepStart = Clock::now();
+}
+
+/**
+ * Push the step into the ring; if the render loop hasn't drained it for a while the step is dropped
+ */
+void FrameProfiler::endStep(float tickLatenessUs) {
+    StepTimes step = { std::chrono::duration<float, std::micro>(Clock::now() - stepStart).count(), tickLatenessUs };
+
+    unsigned tail = stepTail.load(std::memory_order_relaxed);
+    if (tail - stepHead.load(std::memory_order_acquire) >= STEP_CAPACITY) return;
+
+    steps[tail % STEP_CAPACITY] = step;
+    stepTail.store(tail + 1, std::memory_order_release);
+}
+
+/**
+ * Runs on the render thread; the frame keeps the worst step it picked up
+ */
+void FrameProfiler::drainSteps() {
+    unsigned head = stepHead.load(std::memory_order_relaxed);
+    unsigned tail = stepTail.load(std::memory_order_acquire);
+    for (; head != tail; head++) {
+        const StepTimes& step = steps[head % STEP_CAPACITY];
+        current[STEP] = std::max(current[STEP], step.cost);
+        current[TICK_LATENESS] = std::max(current[TICK_LATENESS], step.tickLateness);
+
+        stepWindow[stepWindowHead] = step;
+        stepWindowHead = (stepWindowHead + 1) % WINDOW_STEPS;
+        stepWindowFilled = std::min(stepWindowFilled + 1, WINDOW_STEPS);
+        if (keepLog) {
+            stepLog.push_back(step);
+        }
+    }
+    stepHead.store(head, std::memory_order_release);
+}
+
+TimingStats FrameProfiler::getStats(FramePhase phase) const {
+    return windowStats(static_cast<int>(phase));
+}
+
+TimingStats FrameProfiler::getFrameStats() const {
+    return windowStats(TOTAL);
+}
+
+TimingStats FrameProfiler::getJitterStats() const {
+    return windowStats(JITTER);
+}
+
+TimingStats FrameProfiler::getStepStats() const {
+    return stepStats(stepWindow.data(), stepWindowFilled, false);
+}
+
+TimingStats FrameProfiler::getTickLatenessStats() const {
+    return stepStats(stepWindow.data(), stepWindowFilled, true);
+}
+
+/**
+ * Copy one column of the window into scratch and summarise it
+ */
+TimingStats FrameProfiler::windowStats(int column) const {
+    for (int i = 0; i < windowFilled; i++) {
+        scratch[i] = window[i][column];
+    }
+    return computeStats(scratch.data(), windowFilled);
+}
+
+/**
+ * Copy the chosen timing of the steps into scratch and summarise it
+ */
+TimingStats FrameProfiler::stepStats(const StepTimes* samples, size_t count, bool lateness) const {
+    if (scratch.size() < count) {
+        scratch.resize(count);
+    }
+
+    size_t used = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (!lateness) {
+            scratch[used++] = samples[i].cost;
+        }
+        else if (samples[i].tickLateness >= 0) {
+            scratch[used++] = samples[i].tickLateness;
+        }
+    }
+    return computeStats(scratch.data(), used);
+}
+
+/**
+ * Partial selection instead of a full sort: each percentile's nth_element
+ * only has to partition the part above the previous percentile, so each
+ * value is read before the next call reorders that range
+ */
+TimingStats FrameProfiler::computeStats(float* samples, size_t count) {
+    TimingStats stats;
+    if (count == 0) return stats;
+
+    double sum = 0;
+    for (size_t i = 0; i < count; i++) {
+        sum += samples[i];
+    }
+    stats.mean = static_cast<float>(sum / count);
+
+    size_t p50 = percentileRank(0.50, count);
+    size_t p95 = percentileRank(0.95, count);
+    size_t p99 = percentileRank(0.99, count);
+
+    std::nth_element(samples, samples + p50, samples + count);
+    stats.p50 = samples[p50];
+    std::nth_element(samples + p50, samples + p95, samples + count);
+    stats.p95 = samples[p95];
+    std::nth_element(samples + p95, samples + p99, samples + count);
+    stats.p99 = samples[p99];
+    stats.max = *std::max_element(samples + p99, samples + count);
+    return stats;
+}
+
+/**
+ * Write the timings as CSV or a JSON summary depending on the extension
+ */
+bool FrameProfiler::saveToFile(const std::string& path) const {
+    std::ofstream file(path);
+    if (!file) return false;
+
+    return endsWith(path, ".json") ? writeJson(file) : writeCsv(file);
+}
+
+/**
+ * One row per frame; falls back to the rolling window if no log was kept
+ */
+bool FrameProfiler::writeCsv(std::ostream& out) const {
+    out << "frame";
+    for (const char* name : COLUMN_NAMES) {
+        out << ',' << name << "_us";
+    }
+    out << '\n';
+
+    auto writeRow = [&out](uint64_t frame, const FrameTimes& times) {
+        out << frame;
+        for (float time : times) {
+            out << ',' << time;
+        }
+        out << '\n';
+    };
+
+    if (keepLog) {
+        for (size_t i = 0; i < log.size(); i++) {
+            writeRow(i, log[i]);
+        }
+    }
+    else {
+        // Oldest frame first
+        uint64_t first = frameCount - windowFilled;
+        int start = (windowHead - windowFilled + WINDOW_FRAMES) % WINDOW_FRAMES;
+        for (int i = 0; i < windowFilled; i++) {
+            writeRow(first + i, window[(start + i) % WINDOW_FRAMES]);
+        }
+    }
+    return static_cast<bool>(out);
+}
+
+/**
+ * Percentile summary per phase, total and jitter over every logged frame,
+ * and of the step cost and tick lateness over every logged step
+ */
+bool FrameProfiler::writeJson(std::ostream& out) const {
+    const std::vector<FrameTimes>& frames = keepLog ? log : window;
+    size_t count = keepLog ? log.size() : static_cast<size_t>(windowFilled);
+    const std::vector<StepTimes>& stepSamples = keepLog ? stepLog : stepWindow;
+    size_t stepCount = keepLog ? stepLog.size() : static_cast<size_t>(stepWindowFilled);
+    std::vector<float> samples(count);
+
+    out << "{\n  \"frames\": " << count << ",\n  \"steps\": " << stepCount << ",\n  \"phases\": {\n";
+    for (int column = 0; column < COLUMN_COUNT; column++) {
+        TimingStats stats;
+        if (column >= STEP) {
+            stats = stepStats(stepSamples.data(), stepCount, column == TICK_LATENESS);
+        }
+        else {
+            for (size_t i = 0; i < count; i++) {
+                samples[i] = frames[i][column];
+            }
+            stats = computeStats(samples.data(), count);
+        }
+
+        out << "    \"" << COLUMN_NAMES[column] << "\": { "
+            << "\"p50_us\": " << stats.p50 << ", "
+            << "\"p95_us\": " << stats.p95 << ", "
+            << "\"p99_us\": " << stats.p99 << ", "
+            << "\"max_us\": " << stats.max << ", "
+            << "\"mean_us\": " << stats.mean << " }"
+            << (column + 1 < COLUMN_COUNT ? "," : "") << '\n';
+    }
+    out << "  }\n}\n";
+    return static_cast<bool>(out);
+}
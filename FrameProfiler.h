@@ -0,0 +1,195 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Phases of one pass through the render loop, in the order they run
+ */
+enum class FramePhase {
+    Snapshot,                                   ///< Picking up the latest game snapshot (and waiting for one with on-change pacing)
+    Sync,                                       ///< Updating vertices and HUD text from it
+    Render,                                     ///< Submitting draw calls
+    Present                                     ///< Frame pacing wait and window.display(), including any vsync wait
+};
+
+/**
+ * @brief Distribution of a timing over the rolling window, in microseconds
+ */
+struct TimingStats {
+    float p50 = 0;                              ///< Median
+    float p95 = 0;                              ///< 95th percentile
+    float p99 = 0;                              ///< 99th percentile
+    float max = 0;                              ///< Worst frame
+    float mean = 0;                             ///< Average
+};
+
+/**
+ * @brief High-resolution per-phase timer for the render loop
+ *
+ * The loop calls mark() as each phase finishes and endFrame() once per
+ * frame. Each mark charges the time since the previous mark to its phase,
+ * so the phases of a frame always add up to the full frame time and no
+ * gap between frames goes unaccounted for. That total is also the interval
+ * between two presents, and the change in it from one frame to the next is
+ * tracked as frame pacing jitter.
+ *
+ * The simulation thread reports each of its steps through beginStep() and
+ * endStep(): how long the step took and, when it ran ticks, how late the
+ * oldest of them was. Steps go through a lock-free ring that endFrame()
+ * drains, so the simulation thread never waits for the render loop; if a
+ * frame takes longer than the ring lasts, the newest steps are dropped.
+ *
+ * The last WINDOW_FRAMES frames and WINDOW_STEPS steps are kept in fixed
+ * ring buffers for the rolling percentiles; nothing is allocated per frame
+ * unless a full log was requested for export.
+ */
+class FrameProfiler {
+public:
+    static const int PHASE_COUNT = 4;           ///< Number of FramePhase values
+    static const int WINDOW_FRAMES = 600;       ///< Frames in the rolling statistics (10 s at 60 Hz)
+    static const int WINDOW_STEPS = 10000;      ///< Simulation steps in the rolling statistics (10 s at 1 kHz)
+
+    /**
+     * @brief Constructor - starts timing the first frame
+     *
+     * @param keepLog Also keep every frame's timings so they can be saved on exit
+     */
+    explicit FrameProfiler(bool keepLog = false);
+
+    /**
+     * @brief Charge the time since the previous mark to a phase
+     */
+    void mark(FramePhase phase);
+
+    /**
+     * @brief Record the finished frame and start the next one
+     */
+    void endFrame();
+
+    /**
+     * @brief Start timing a simulation step (simulation thread only)
+     */
+    void beginStep();
+
+    /**
+     * @brief Record the simulation step started by beginStep (simulation thread only)
+     *
+     * @param tickLatenessUs How long the oldest tick this step ran had been due (negative = no tick ran)
+     */
+    void endStep(float tickLatenessUs);
+
+    /**
+     * @brief Rolling statistics of one phase
+     */
+    TimingStats getStats(FramePhase phase) const;
+
+    /**
+     * @brief Rolling statistics of the whole frame
+     */
+    TimingStats getFrameStats() const;
+
+    /**
+     * @brief Rolling statistics of the frame interval jitter
+     *
+     * Jitter is how much a frame's length differs from the previous frame's,
+     * so a steady frame rate scores near zero whatever the rate is.
+     */
+    TimingStats getJitterStats() const;
+
+    /**
+     * @brief Rolling statistics of the simulation step cost
+     */
+    TimingStats getStepStats() const;
+
+    /**
+     * @brief Rolling statistics of how late ticks ran, over the steps that ran any
+     *
+     * Steps run about once a millisecond, so this stays near zero until the
+     * simulation thread is held up and has a backlog of ticks to catch up on.
+     */
+    TimingStats getTickLatenessStats() const;
+
+    uint64_t getFrameCount() const { return frameCount; }
+
+    /**
+     * @brief Save the timings to disk
+     *
+     * A path ending in ".json" gets a percentile summary of the whole session
+     * (or of the rolling window if no log was kept); anything else gets CSV
+     * with one row per logged frame, where the step and tick lateness columns
+     * hold the worst simulation step handed over during that frame.
+     *
+     * @param path Output file
+     * @return false if the file could not be written
+     */
+    bool saveToFile(const std::string& path) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+    static const int TOTAL = PHASE_COUNT;       ///< Index of the frame total in FrameTimes
+    static const int JITTER = PHASE_COUNT + 1;  ///< Index of the jitter in FrameTimes
+    static const int STEP = PHASE_COUNT + 2;    ///< Index of the frame's worst step cost in FrameTimes
+    static const int TICK_LATENESS = PHASE_COUNT + 3;   ///< Index of the frame's worst tick lateness in FrameTimes
+    static const int COLUMN_COUNT = PHASE_COUNT + 4;
+    static const unsigned STEP_CAPACITY = 1024; ///< Steps that can wait for the next endFrame() (1 s at 1 kHz)
+
+    using FrameTimes = std::array<float, COLUMN_COUNT>;  ///< Microseconds per phase, then the total, the jitter and the worst step
+
+    /**
+     * @brief One simulation step in microseconds
+     */
+    struct StepTimes {
+        float cost;                             ///< Time spent in the step
+        float tickLateness;                     ///< How late its oldest tick was (negative = no tick ran)
+    };
+
+    /**
+     * @brief Percentiles of a set of samples (reorders the samples)
+     */
+    static TimingStats computeStats(float* samples, size_t count);
+
+    /**
+     * @brief Statistics of one column of the rolling window
+     */
+    TimingStats windowStats(int column) const;
+
+    /**
+     * @brief Statistics of the step costs or tick latenesses of some steps (latenesses skip steps without ticks)
+     */
+    TimingStats stepStats(const StepTimes* samples, size_t count, bool lateness) const;
+
+    /**
+     * @brief Move the steps reported since the last frame into the window, log and current frame
+     */
+    void drainSteps();
+
+    bool writeCsv(std::ostream& out) const;
+    bool writeJson(std::ostream& out) const;
+
+    Clock::time_point lastMark;                 ///< When the previous phase ended
+    FrameTimes current;                         ///< Timings of the frame in progress
+    float previousTotal;                        ///< Length of the previous frame (negative before the first)
+    std::vector<FrameTimes> window;             ///< Ring buffer of the last WINDOW_FRAMES frames
+    int windowHead;                             ///< Next slot to overwrite
+    int windowFilled;                           ///< Valid frames in the window
+    uint64_t frameCount;                        ///< Frames recorded since startup
+    bool keepLog;                               ///< Whether every frame goes to log
+    std::vector<FrameTimes> log;                ///< Every frame, for export
+    mutable std::vector<float> scratch;         ///< Working copy for nth_element
+
+    // Simulation steps
+    Clock::time_point stepStart;                ///< When the current step began (simulation thread)
+    StepTimes steps[STEP_CAPACITY];             ///< Ring of steps not drained yet
+    std::atomic<unsigned> stepHead;             ///< Next step to drain (written by the render thread)
+    std::atomic<unsigned> stepTail;             ///< Next free slot (written by the simulation thread)
+    std::vector<StepTimes> stepWindow;          ///< Ring buffer of the last WINDOW_STEPS steps
+    int stepWindowHead;                         ///< Next slot to overwrite
+    int stepWindowFilled;                       ///< Valid steps in the window
+    std::vector<StepTimes> stepLog;             ///< Every step, for export
+};
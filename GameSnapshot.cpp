@@ -0,0 +1,40 @@
+#include "GameSnapshot.h"
+#include <algorithm>
+
+/**
+ * Copy the board, piece and counters out of the engine
+ */
+void GameSnapshot::capture(const TetrisEngine& engine, int64_t captureTime) {
+    for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; y++) {
+        for (int x = 0; x < TetrisEngine::BOARD_WIDTH; x++) {
+            cells[y][x] = static_cast<uint8_t>(engine.getCell(x, y));
+        }
+    }
+
+    piece = engine.getCurrentPiece();
+    nextType = engine.getNextType();
+    score = engine.getScore();
+    level = engine.getLevel();
+    linesCleared = engine.getLinesCleared();
+    gameOver = engine.isGameOver();
+
+    ActivePiece below = piece;
+    below.y++;
+    canFall = !gameOver && engine.isValidPosition(below);
+
+    dropCounter = engine.getDropCounter();
+    dropIntervalTicks = engine.getDropIntervalTicks();
+    tick = engine.getTickCount();
+    time = captureTime;
+}
+
+/**
+ * Progress through the drop interval, continued past the capture at the tick rate
+ */
+float GameSnapshot::fallFraction(int64_t now) const {
+    if (!canFall) return 0;
+
+    double ticks = dropCounter + static_cast<double>(now - time) * TetrisEngine::TICK_RATE / 1000000.0;
+    double fraction = ticks / dropIntervalTicks;
+    return static_cast<float>(std::min(std::max(fraction, 0.0), 0.999));
+}
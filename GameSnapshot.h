@@ -0,0 +1,47 @@
+#pragma once
+
+#include "TetrisEngine.h"
+#include <cstdint>
+
+/**
+ * @brief Immutable copy of everything the renderer shows
+ *
+ * The simulation thread captures one after every change and hands it to the
+ * render thread through a TripleBuffer, so drawing never touches the live
+ * engine. It is plain data (about 250 bytes) and cheap to copy.
+ */
+struct GameSnapshot {
+    uint8_t cells[TetrisEngine::BOARD_HEIGHT][TetrisEngine::BOARD_WIDTH];  ///< Color index per settled cell (0 = empty)
+    ActivePiece piece;                          ///< Falling piece
+    int nextType;                               ///< Type of the upcoming piece
+    int score;                                  ///< Current score
+    int level;                                  ///< Current level
+    int linesCleared;                           ///< Total lines cleared
+    bool gameOver;                              ///< Whether the game has ended
+    bool canFall;                               ///< Whether the falling piece has room to drop one more row
+    int dropCounter;                            ///< Ticks since the last automatic drop
+    int dropIntervalTicks;                      ///< Ticks between automatic drops
+    uint64_t tick;                              ///< Engine tick count
+    int64_t time;                               ///< Shared clock time of the capture in microseconds
+    bool soundEnabled;                          ///< Sound state for the HUD
+    bool demoMode;                              ///< Whether the AI is playing
+
+    /**
+     * @brief Copy the engine's visible state
+     *
+     * @param engine Engine to copy from
+     * @param captureTime Clock time of the capture in microseconds
+     *
+     * The front end fills in soundEnabled and demoMode itself.
+     */
+    void capture(const TetrisEngine& engine, int64_t captureTime);
+
+    /**
+     * @brief Rows the falling piece has fallen past its cell, for smooth drawing
+     *
+     * @param now Clock time in microseconds
+     * @return Fraction of a row in [0, 1), extrapolated from the drop timer
+     *         (0 if the piece is resting or the game is over)
+     */
+    float fallFraction(int64_t now) const;
+};
@@ -0,0 +1,142 @@
+#include "InputController.h"
+
+/**
+ * Constructor - Start with every button up
+ */
+InputController::InputController(const InputSettings& settings) :
+    settings(settings),
+    left(),
+    right(),
+    softDrop(),
+    activeShift(InputKey::Left),
+    commands(),
+    commandCount(0)
+{
+}
+
+/**
+ * Act on a button going down
+ */
+void InputController::press(InputKey key) {
+    // With neither a delay nor a repeat interval, a tap goes straight to the wall
+    switch (key) {
+    case InputKey::Left:
+        activeShift = InputKey::Left;
+        beginHold(left, Action::MoveLeft, settings.dasTicks > 0 ? 1 : settings.arrTicks);
+        break;
+
+    case InputKey::Right:
+        activeShift = InputKey::Right;
+        beginHold(right, Action::MoveRight, settings.dasTicks > 0 ? 1 : settings.arrTicks);
+        break;
+
+    case InputKey::SoftDrop:
+        beginHold(softDrop, Action::SoftDrop, settings.softDropTicks);
+        break;
+
+    case InputKey::Rotate:
+        emit(Action::Rotate, 1);
+        break;
+
+    case InputKey::HardDrop:
+        emit(Action::HardDrop, 1);
+        break;
+
+    case InputKey::Restart:
+        emit(Action::Restart, 1);
+        break;
+    }
+}
+
+/**
+ * Stop repeating a button; hand the shift back to the other direction if it is still held
+ */
+void InputController::release(InputKey key) {
+    switch (key) {
+    case InputKey::Left:
+        left.held = false;
+        if (activeShift == InputKey::Left && right.held) {
+            press(InputKey::Right);
+        }
+        break;
+
+    case InputKey::Right:
+        right.held = false;
+        if (activeShift == InputKey::Right && left.held) {
+            press(InputKey::Left);
+        }
+        break;
+
+    case InputKey::SoftDrop:
+        softDrop.held = false;
+        break;
+
+    default:
+        break;
+    }
+}
+
+void InputController::releaseAll() {
+    left.held = false;
+    right.held = false;
+    softDrop.held = false;
+}
+
+/**
+ * Count one more tick of holding and emit the repeats that are due
+ */
+void InputController::tick() {
+    if (activeShift == InputKey::Left) {
+        repeat(left, Action::MoveLeft, settings.dasTicks, settings.arrTicks);
+    }
+    else {
+        repeat(right, Action::MoveRight, settings.dasTicks, settings.arrTicks);
+    }
+    repeat(softDrop, Action::SoftDrop, settings.softDropTicks, settings.softDropTicks);
+}
+
+/**
+ * Hand over the pending commands
+ */
+int InputController::takeCommands(InputCommand out[MAX_COMMANDS]) {
+    int count = commandCount;
+    for (int i = 0; i < count; i++) {
+        out[i] = commands[i];
+    }
+    commandCount = 0;
+    return count;
+}
+
+void InputController::emit(Action action, int count) {
+    if (commandCount < MAX_COMMANDS) {
+        commands[commandCount].action = action;
+        commands[commandCount].count = count;
+        commandCount++;
+    }
+}
+
+/**
+ * Act once (or all the way) and restart the button's timer
+ */
+void InputController::beginHold(RepeatState& state, Action action, int rate) {
+    state.held = true;
+    state.heldTicks = 0;
+    emit(action, rate > 0 ? 1 : AS_FAR_AS_POSSIBLE);
+}
+
+/**
+ * Repeat after the delay, then every rate ticks (every tick, all the way, for rate 0)
+ */
+void InputController::repeat(RepeatState& state, Action action, int delay, int rate) {
+    if (!state.held) return;
+
+    state.heldTicks++;
+    if (state.heldTicks < delay) return;
+
+    if (rate <= 0) {
+        emit(action, AS_FAR_AS_POSSIBLE);
+    }
+    else if ((state.heldTicks - delay) % rate == 0) {
+        emit(action, 1);
+    }
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "TetrisEngine.h"
+
+/**
+ * @brief Gameplay buttons handled by the input layer
+ */
+enum class InputKey {
+    Left,       ///< Shift left (auto-repeats)
+    Right,      ///< Shift right (auto-repeats)
+    SoftDrop,   ///< Soft drop (auto-repeats)
+    Rotate,     ///< Rotate clockwise (once per press)
+    HardDrop,   ///< Hard drop (once per press)
+    Restart     ///< Restart after game over (once per press)
+};
+
+/**
+ * @brief Auto-shift timing, in simulation ticks
+ */
+struct InputSettings {
+    int dasTicks = 10;                          ///< Delayed auto shift: hold time before a shift starts repeating
+    int arrTicks = 2;                           ///< Auto repeat rate: ticks between repeated shifts (0 = straight to the wall)
+    int softDropTicks = 2;                      ///< Ticks between repeated soft drops (0 = straight to the floor)
+};
+
+/**
+ * @brief An action to apply, possibly several times in a row
+ */
+struct InputCommand {
+    Action action;                              ///< Action to apply
+    int count;                                  ///< Times to apply it
+};
+
+/**
+ * @brief Delayed-auto-shift / auto-repeat input layer
+ *
+ * Turns button presses and releases into engine actions with timing that
+ * depends only on the simulation tick, not on the operating system's key
+ * repeat delay and rate. A press acts immediately; holding a shift or soft
+ * drop then repeats it on tick(), which the game calls once per simulation
+ * tick. The front end feeds press() and release() in the order the events
+ * happened, interleaved with the ticks they happened between.
+ *
+ * When both shift directions are held, the one pressed last wins; letting
+ * go of it hands control back to the other with a fresh delay.
+ *
+ * The controller has no dependency on SFML or the engine's state. Repeats
+ * that go "as far as possible" (an ARR or soft drop rate of 0) come out as
+ * commands the caller resolves with TetrisEngine::getTravelDistance.
+ * Commands are collected in a fixed-size array; nothing allocates.
+ */
+class InputController {
+public:
+    static const int KEY_COUNT = 6;             ///< Number of InputKey values
+    static const int MAX_COMMANDS = 4;          ///< Commands one press, release or tick can produce
+    static const int AS_FAR_AS_POSSIBLE = -1;   ///< InputCommand::count for a shift to the wall or floor
+
+    explicit InputController(const InputSettings& settings = InputSettings());
+
+    /**
+     * @brief A button went down
+     */
+    void press(InputKey key);
+
+    /**
+     * @brief A button went up
+     */
+    void release(InputKey key);
+
+    /**
+     * @brief Let go of every button (e.g. when the window loses focus)
+     */
+    void releaseAll();
+
+    /**
+     * @brief Advance the auto-repeat timers by one simulation tick
+     */
+    void tick();
+
+    /**
+     * @brief Move the commands produced since the last call into out
+     *
+     * @param out Receives up to MAX_COMMANDS commands
+     * @return Number of commands written
+     */
+    int takeCommands(InputCommand out[MAX_COMMANDS]);
+
+    const InputSettings& getSettings() const { return settings; }
+
+private:
+    /**
+     * @brief Hold state of one auto-repeating button
+     */
+    struct RepeatState {
+        bool held;                              ///< Whether the button is down
+        int heldTicks;                          ///< Ticks since the button went down
+    };
+
+    InputSettings settings;                     ///< Repeat timing
+    RepeatState left;                           ///< Left shift button
+    RepeatState right;                          ///< Right shift button
+    RepeatState softDrop;                       ///< Soft drop button
+    InputKey activeShift;                       ///< Direction that wins while both shifts are held
+    InputCommand commands[MAX_COMMANDS];        ///< Commands not taken yet
+    int commandCount;                           ///< Valid entries in commands
+
+    void emit(Action action, int count);
+
+    /**
+     * @brief Start holding a button: act now and restart its timer
+     *
+     * @param state Button going down
+     * @param action Action it performs
+     * @param rate Repeat rate; 0 makes the first action go as far as possible too
+     */
+    void beginHold(RepeatState& state, Action action, int rate);
+
+    /**
+     * @brief Emit the repeat due this tick, if any
+     *
+     * @param state Button being held
+     * @param action Action it repeats
+     * @param delay Ticks before the first repeat
+     * @param rate Ticks between repeats (0 = as far as possible)
+     */
+    void repeat(RepeatState& state, Action action, int delay, int rate);
+};
@@ -0,0 +1,416 @@
+#include "LockstepPeer.h"
+#include <SFML/System/Sleep.hpp>
+#include <algorithm>
+
+namespace {
+    const uint8_t PROTOCOL_VERSION = 1;
+
+    /**
+     * @brief First byte of every packet
+     */
+    enum MessageType : uint8_t {
+        Hello = 1,      // Joiner -> host: version, joiner's DAS, ARR, soft drop
+        Welcome,        // Host -> joiner: version, seed, input delay, host's DAS, ARR, soft drop
+        Inputs,         // Either way: ack, first tick, count, count button bytes
+        Check,          // Either way: tick, match hash
+        Bye             // Either way: leaving
+    };
+
+    const size_t HELLO_SIZE = 5;
+    const size_t WELCOME_SIZE = 10;
+    const size_t INPUTS_HEADER_SIZE = 6;
+    const size_t CHECK_SIZE = 13;
+    const size_t MAX_PACKET_SIZE = INPUTS_HEADER_SIZE + LockstepPeer::INPUT_WINDOW;
+
+    const sf::Time HELLO_INTERVAL = sf::milliseconds(100);     // Joiner's handshake retry interval
+    const sf::Time RESEND_INTERVAL = sf::milliseconds(15);     // Resend unacknowledged buttons this often while idle
+    const sf::Time KEEPALIVE_INTERVAL = sf::milliseconds(100); // Send something at least this often
+    const sf::Time CONNECTION_TIMEOUT = sf::seconds(5);        // Silence after which the other side is gone
+    const sf::Time HANDSHAKE_POLL = sf::milliseconds(1);
+    const int BYE_REPEATS = 3;                                 // Goodbyes sent, in case some are lost
+    const uint32_t NO_TICK = 0xFFFFFFFFu;
+
+    void writeUint16(uint8_t* out, uint16_t value) {
+        out[0] = static_cast<uint8_t>(value);
+        out[1] = static_cast<uint8_t>(value >> 8);
+    }
+
+    void writeUint32(uint8_t* out, uint32_t value) {
+        for (int i = 0; i < 4; i++) {
+            out[i] = static_cast<uint8_t>(value >> (i * 8));
+        }
+    }
+
+    uint16_t readUint16(const uint8_t* in) {
+        return static_cast<uint16_t>(in[0] | (in[1] << 8));
+    }
+
+    uint32_t readUint32(const uint8_t* in) {
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) {
+            value |= static_cast<uint32_t>(in[i]) << (i * 8);
+        }
+        return value;
+    }
+
+    /**
+     * Full tick nearest to `reference` whose low 16 bits are `value`
+     */
+    uint32_t expandTick(uint16_t value, uint32_t reference) {
+        return reference + static_cast<uint32_t>(static_cast<int16_t>(value - static_cast<uint16_t>(reference)));
+    }
+
+    /**
+     * Settings travel as one byte each; the handshake rejects nothing, so clamp
+     */
+    uint8_t settingByte(int ticks) {
+        return static_cast<uint8_t>(std::max(0, std::min(ticks, 255)));
+    }
+
+    void writeSettings(uint8_t* out, const InputSettings& settings) {
+        out[0] = settingByte(settings.dasTicks);
+        out[1] = settingByte(settings.arrTicks);
+        out[2] = settingByte(settings.softDropTicks);
+    }
+
+    InputSettings readSettings(const uint8_t* in) {
+        InputSettings settings;
+        settings.dasTicks = in[0];
+        settings.arrTicks = in[1];
+        settings.softDropTicks = in[2];
+        return settings;
+    }
+}
+
+/**
+ * Constructor - Not connected until host() or join() succeeds
+ */
+LockstepPeer::LockstepPeer() :
+    remotePort(0),
+    connected(false),
+    desynced(false),
+    localPlayer(0),
+    seed(0),
+    inputDelay(DEFAULT_INPUT_DELAY),
+    bytesSent(0),
+    packetsSent(0)
+{
+    reset(0);
+}
+
+LockstepPeer::~LockstepPeer() {
+    disconnect();
+}
+
+/**
+ * Clear the input and checksum history for a new session
+ */
+void LockstepPeer::reset(int player) {
+    localPlayer = player;
+    connected = false;
+    desynced = false;
+    std::fill(localInputs, localInputs + INPUT_WINDOW, 0);
+    std::fill(remoteInputs, remoteInputs + INPUT_WINDOW, 0);
+    // Ticks before the delay have nothing held on either side, so nothing needs to be sent for them
+    nextLocalTick = static_cast<uint32_t>(inputDelay);
+    remoteReceived = static_cast<uint32_t>(inputDelay);
+    remoteAck = static_cast<uint32_t>(inputDelay);
+    nextTakeTick = 0;
+    localInputAdded = false;
+    ackPending = false;
+    for (int i = 0; i < CHECKSUM_SLOTS; i++) {
+        localChecks[i] = { NO_TICK, 0 };
+        remoteChecks[i] = { NO_TICK, 0 };
+    }
+    bytesSent = 0;
+    packetsSent = 0;
+}
+
+/**
+ * Wait for a Hello, answer it and go non-blocking
+ */
+bool LockstepPeer::host(unsigned short port, uint32_t seed, int inputDelay, const InputSettings& settings,
+                        sf::Time timeout, std::string& error) {
+    disconnect();
+    this->seed = seed;
+    this->inputDelay = std::max(1, std::min(inputDelay, static_cast<int>(MAX_INPUT_DELAY)));
+    this->settings[0] = settings;
+    reset(0);
+
+    socket.unbind();
+    if (socket.bind(port) != sf::Socket::Done) {
+        error = "cannot listen on UDP port " + std::to_string(port);
+        return false;
+    }
+    socket.setBlocking(false);
+
+    sf::Clock waited;
+    uint8_t packet[MAX_PACKET_SIZE];
+    while (waited.getElapsedTime() < timeout) {
+        std::size_t received = 0;
+        sf::IpAddress sender;
+        unsigned short senderPort = 0;
+        while (socket.receive(packet, sizeof(packet), received, sender, senderPort) == sf::Socket::Done) {
+            if (received < HELLO_SIZE || packet[0] != Hello) continue;
+            if (packet[1] != PROTOCOL_VERSION) {
+                error = "joiner from " + sender.toString() + " uses another protocol version";
+                return false;
+            }
+            remoteAddress = sender;
+            remotePort = senderPort;
+            this->settings[1] = readSettings(packet + 2);
+            connected = true;
+            lastReceived.restart();
+            sendWelcome();
+            return true;
+        }
+        sf::sleep(HANDSHAKE_POLL);
+    }
+
+    error = "no one joined within " + std::to_string(static_cast<int>(timeout.asSeconds())) + " s";
+    return false;
+}
+
+/**
+ * Send Hello until a Welcome comes back, then go non-blocking
+ */
+bool LockstepPeer::join(const sf::IpAddress& address, unsigned short port, const InputSettings& settings,
+                        sf::Time timeout, std::string& error) {
+    disconnect();
+    if (address == sf::IpAddress::None) {
+        error = "invalid host address";
+        return false;
+    }
+    remoteAddress = address;
+    remotePort = port;
+    this->settings[1] = settings;
+
+    socket.unbind();
+    if (socket.bind(sf::Socket::AnyPort) != sf::Socket::Done) {
+        error = "cannot open a UDP socket";
+        return false;
+    }
+    socket.setBlocking(false);
+
+    uint8_t hello[HELLO_SIZE] = { Hello, PROTOCOL_VERSION };
+    writeSettings(hello + 2, settings);
+
+    sf::Clock waited;
+    sf::Clock sinceHello;
+    bool first = true;
+    uint8_t packet[MAX_PACKET_SIZE];
+    while (waited.getElapsedTime() < timeout) {
+        if (first || sinceHello.getElapsedTime() >= HELLO_INTERVAL) {
+            socket.send(hello, sizeof(hello), remoteAddress, remotePort);
+            sinceHello.restart();
+            first = false;
+        }
+
+        std::size_t received = 0;
+        sf::IpAddress sender;
+        unsigned short senderPort = 0;
+        while (socket.receive(packet, sizeof(packet), received, sender, senderPort) == sf::Socket::Done) {
+            if (sender != remoteAddress || senderPort != remotePort) continue;
+            if (received < WELCOME_SIZE || packet[0] != Welcome) continue;
+            if (packet[1] != PROTOCOL_VERSION) {
+                error = "host uses another protocol version";
+                return false;
+            }
+            seed = readUint32(packet + 2);
+            inputDelay = std::max(1, std::min(static_cast<int>(packet[6]), static_cast<int>(MAX_INPUT_DELAY)));
+            this->settings[0] = readSettings(packet + 7);
+            reset(1);
+            connected = true;
+            lastReceived.restart();
+            lastSent.restart();
+            return true;
+        }
+        sf::sleep(HANDSHAKE_POLL);
+    }
+
+    error = "no answer from " + address.toString() + ":" + std::to_string(port);
+    return false;
+}
+
+void LockstepPeer::sendWelcome() {
+    uint8_t welcome[WELCOME_SIZE] = { Welcome, PROTOCOL_VERSION };
+    writeUint32(welcome + 2, seed);
+    welcome[6] = static_cast<uint8_t>(inputDelay);
+    writeSettings(welcome + 7, settings[0]);
+    send(welcome, sizeof(welcome));
+}
+
+void LockstepPeer::send(const uint8_t* data, size_t size) {
+    socket.send(data, size, remoteAddress, remotePort);
+    bytesSent += size;
+    packetsSent++;
+    lastSent.restart();
+}
+
+/**
+ * Drain the socket; packets from anyone but the other side are ignored
+ */
+void LockstepPeer::poll() {
+    if (!connected) return;
+
+    uint8_t packet[MAX_PACKET_SIZE];
+    std::size_t received = 0;
+    sf::IpAddress sender;
+    unsigned short senderPort = 0;
+    while (socket.receive(packet, sizeof(packet), received, sender, senderPort) == sf::Socket::Done) {
+        if (sender != remoteAddress || senderPort != remotePort || received == 0) continue;
+        lastReceived.restart();
+        handlePacket(packet, received);
+        if (!connected) return;
+    }
+
+    if (lastReceived.getElapsedTime() > CONNECTION_TIMEOUT) {
+        connected = false;
+    }
+}
+
+void LockstepPeer::handlePacket(const uint8_t* data, size_t size) {
+    switch (data[0]) {
+    case Hello:
+        // Our Welcome was lost; the joiner is still waiting for it
+        if (localPlayer == 0) sendWelcome();
+        break;
+    case Inputs:
+        handleInputs(data, size);
+        break;
+    case Check:
+        if (size >= CHECK_SIZE) {
+            uint32_t tick = readUint32(data + 1);
+            uint64_t hash = readUint32(data + 5) | (static_cast<uint64_t>(readUint32(data + 9)) << 32);
+            remoteChecks[(tick / CHECK_INTERVAL) % CHECKSUM_SLOTS] = { tick, hash };
+            compareChecksums();
+        }
+        break;
+    case Bye:
+        connected = false;
+        break;
+    default:
+        break;
+    }
+}
+
+/**
+ * Take the acknowledgement, then append whatever extends the run of remote buttons we have
+ */
+void LockstepPeer::handleInputs(const uint8_t* data, size_t size) {
+    if (size < INPUTS_HEADER_SIZE) return;
+    uint32_t ack = expandTick(readUint16(data + 1), remoteAck);
+    uint32_t first = expandTick(readUint16(data + 3), remoteReceived);
+    size_t count = data[5];
+    if (size < INPUTS_HEADER_SIZE + count) return;
+
+    if (ack > remoteAck && ack <= nextLocalTick) {
+        remoteAck = ack;
+    }
+
+    // Packets carry everything from the sender's view of our ack on, so a gap means an old, reordered packet
+    if (first > remoteReceived) return;
+    const uint8_t* keys = data + INPUTS_HEADER_SIZE;
+    for (uint32_t tick = first; tick < first + count; tick++) {
+        if (tick < remoteReceived) continue;
+        // The slot still holds a tick the match hasn't taken; the sender will repeat this one
+        if (tick >= nextTakeTick + INPUT_WINDOW) break;
+        remoteInputs[tick % INPUT_WINDOW] = keys[tick - first];
+        remoteReceived = tick + 1;
+        ackPending = true;
+    }
+}
+
+/**
+ * One packet with every unacknowledged button byte as soon as there are new
+ * ones; acknowledgements and repeats ride along, or go out on their own
+ * once nothing new has been sent for a while
+ */
+void LockstepPeer::flush() {
+    if (!connected) return;
+
+    sf::Time sinceSent = lastSent.getElapsedTime();
+    bool outstanding = ackPending || remoteAck != nextLocalTick;
+    if (!localInputAdded && !(outstanding && sinceSent >= RESEND_INTERVAL) && sinceSent < KEEPALIVE_INTERVAL) return;
+
+    uint8_t packet[MAX_PACKET_SIZE];
+    uint32_t count = nextLocalTick - remoteAck;
+    packet[0] = Inputs;
+    writeUint16(packet + 1, static_cast<uint16_t>(remoteReceived));
+    writeUint16(packet + 3, static_cast<uint16_t>(remoteAck));
+    packet[5] = static_cast<uint8_t>(count);
+    for (uint32_t i = 0; i < count; i++) {
+        packet[INPUTS_HEADER_SIZE + i] = localInputs[(remoteAck + i) % INPUT_WINDOW];
+    }
+    send(packet, INPUTS_HEADER_SIZE + count);
+    localInputAdded = false;
+    ackPending = false;
+}
+
+/**
+ * Stay inputDelay ticks ahead of the match, but never overwrite a slot that
+ * is still unacknowledged or not yet taken
+ */
+bool LockstepPeer::needsLocalInput(uint32_t matchTick) const {
+    return nextLocalTick <= matchTick + static_cast<uint32_t>(inputDelay) &&
+           nextLocalTick < remoteAck + INPUT_WINDOW &&
+           nextLocalTick < nextTakeTick + INPUT_WINDOW;
+}
+
+void LockstepPeer::submitLocalInput(uint8_t keys) {
+    localInputs[nextLocalTick % INPUT_WINDOW] = keys;
+    nextLocalTick++;
+    localInputAdded = true;
+}
+
+bool LockstepPeer::hasInputs(uint32_t tick) const {
+    if (tick < static_cast<uint32_t>(inputDelay)) return true;
+    return tick < nextLocalTick && tick < remoteReceived;
+}
+
+void LockstepPeer::takeInputs(uint32_t tick, uint8_t keys[2]) {
+    uint8_t local = 0;
+    uint8_t remote = 0;
+    if (tick >= static_cast<uint32_t>(inputDelay)) {
+        local = localInputs[tick % INPUT_WINDOW];
+        remote = remoteInputs[tick % INPUT_WINDOW];
+    }
+    keys[localPlayer] = local;
+    keys[1 - localPlayer] = remote;
+    nextTakeTick = tick + 1;
+}
+
+/**
+ * Checks are sent once; a lost one just means that interval goes unchecked
+ */
+void LockstepPeer::submitChecksum(uint32_t tick, uint64_t hash) {
+    if (!connected) return;
+
+    localChecks[(tick / CHECK_INTERVAL) % CHECKSUM_SLOTS] = { tick, hash };
+    compareChecksums();
+
+    uint8_t packet[CHECK_SIZE] = { Check };
+    writeUint32(packet + 1, tick);
+    writeUint32(packet + 5, static_cast<uint32_t>(hash));
+    writeUint32(packet + 9, static_cast<uint32_t>(hash >> 32));
+    send(packet, sizeof(packet));
+}
+
+void LockstepPeer::compareChecksums() {
+    for (int i = 0; i < CHECKSUM_SLOTS; i++) {
+        if (localChecks[i].tick != NO_TICK && localChecks[i].tick == remoteChecks[i].tick &&
+            localChecks[i].hash != remoteChecks[i].hash) {
+            desynced = true;
+        }
+    }
+}
+
+void LockstepPeer::disconnect() {
+    if (!connected) return;
+
+    const uint8_t bye[1] = { Bye };
+    for (int i = 0; i < BYE_REPEATS; i++) {
+        send(bye, sizeof(bye));
+    }
+    connected = false;
+}
@@ -0,0 +1,177 @@
+#pragma once
+
+#include "InputController.h"
+#include <SFML/Network/IpAddress.hpp>
+#include <SFML/Network/UdpSocket.hpp>
+#include <SFML/System/Clock.hpp>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief One side of a two-player lockstep connection over UDP
+ *
+ * The host picks the seed and the input delay and waits for a joiner; the
+ * joiner sends its auto-repeat settings and gets the host's back. From then
+ * on the only traffic is one byte of held buttons per player per tick:
+ * the button byte sampled on tick t is scheduled for tick t + inputDelay
+ * and sent right away, so it normally arrives before either side needs it
+ * and the game never waits. Ticks before the delay have no buttons held.
+ *
+ * Every packet carries all of this side's buttons the other side hasn't
+ * acknowledged yet plus an acknowledgement of the other side's, so a lost
+ * packet is repaired by the next one without retransmission timers. A
+ * packet is a 6-byte header plus one byte per unacknowledged tick and goes
+ * out when there are new buttons, so about one packet and 7 to 10 bytes
+ * per tick on a LAN; acknowledgements alone wait for the next one.
+ *
+ * Every CHECK_INTERVAL ticks the sides also swap a hash of their match
+ * state; a mismatch marks the session as desynchronised.
+ *
+ * Use from one thread only. Host and joiner are player 0 and player 1.
+ */
+class LockstepPeer {
+public:
+    static const unsigned short DEFAULT_PORT = 47474;   ///< Port the host listens on by default
+    static const int DEFAULT_INPUT_DELAY = 3;   ///< Ticks between sampling buttons and applying them (50 ms)
+    static const int MAX_INPUT_DELAY = 30;      ///< Longest input delay accepted
+    static const int CHECK_INTERVAL = 60;       ///< Ticks between match hash comparisons
+    static const int INPUT_WINDOW = 128;        ///< Ticks of buttons buffered per side (also caps a packet's button count)
+
+    LockstepPeer();
+
+    /**
+     * @brief Says goodbye to the other side if still connected
+     */
+    ~LockstepPeer();
+
+    LockstepPeer(const LockstepPeer&) = delete;
+    LockstepPeer& operator=(const LockstepPeer&) = delete;
+
+    /**
+     * @brief Listen on a port and wait for a joiner
+     *
+     * @param port UDP port to listen on
+     * @param seed Seed both engines will use
+     * @param inputDelay Ticks of input delay, clamped to 1..MAX_INPUT_DELAY
+     * @param settings This player's auto-repeat timing
+     * @param timeout How long to wait for a joiner
+     * @param error Receives a description on failure
+     */
+    bool host(unsigned short port, uint32_t seed, int inputDelay, const InputSettings& settings,
+              sf::Time timeout, std::string& error);
+
+    /**
+     * @brief Join a host
+     *
+     * @param address Host's address
+     * @param port Host's port
+     * @param settings This player's auto-repeat timing
+     * @param timeout How long to keep trying
+     * @param error Receives a description on failure
+     */
+    bool join(const sf::IpAddress& address, unsigned short port, const InputSettings& settings,
+              sf::Time timeout, std::string& error);
+
+    /**
+     * @brief Receive every pending packet (call every step)
+     */
+    void poll();
+
+    /**
+     * @brief Send buttons and acknowledgements if there is anything new (call every step)
+     */
+    void flush();
+
+    /**
+     * @brief Whether this side's buttons for a later tick are due
+     *
+     * @param matchTick Tick the match will run next
+     */
+    bool needsLocalInput(uint32_t matchTick) const;
+
+    /**
+     * @brief Queue this side's held buttons for the next tick that has none yet
+     */
+    void submitLocalInput(uint8_t keys);
+
+    /**
+     * @brief Whether both sides' buttons for a tick have arrived
+     */
+    bool hasInputs(uint32_t tick) const;
+
+    /**
+     * @brief Both players' buttons for a tick, indexed by player
+     *
+     * Only valid if hasInputs(tick); ticks must be taken in order.
+     */
+    void takeInputs(uint32_t tick, uint8_t keys[2]);
+
+    /**
+     * @brief Compare a match hash with the other side's hash for the same tick
+     */
+    void submitChecksum(uint32_t tick, uint64_t hash);
+
+    /**
+     * @brief Tell the other side we are leaving
+     */
+    void disconnect();
+
+    /**
+     * @brief Whether the other side has acknowledged every button sent
+     */
+    bool allInputsAcknowledged() const { return remoteAck == nextLocalTick; }
+
+    int getLocalPlayer() const { return localPlayer; }
+    uint32_t getSeed() const { return seed; }
+    int getInputDelay() const { return inputDelay; }
+    const InputSettings& getPlayerSettings(int player) const { return settings[player]; }
+    bool isConnected() const { return connected; }
+    bool isDesynced() const { return desynced; }
+    uint64_t getBytesSent() const { return bytesSent; }
+    uint64_t getPacketsSent() const { return packetsSent; }
+
+private:
+    /**
+     * @brief A match hash at a tick
+     */
+    struct Checksum {
+        uint32_t tick;
+        uint64_t hash;
+    };
+
+    static const int CHECKSUM_SLOTS = 4;        ///< Recent checksums kept per side
+
+    sf::UdpSocket socket;                       ///< Non-blocking once connected
+    sf::IpAddress remoteAddress;                ///< Other side's address
+    unsigned short remotePort;                  ///< Other side's port
+    bool connected;                             ///< Handshake done and no goodbye or timeout since
+    bool desynced;                              ///< A checksum differed
+    int localPlayer;                            ///< 0 = host, 1 = joiner
+    uint32_t seed;                              ///< Shared engine seed
+    int inputDelay;                             ///< Ticks between sampling and applying buttons
+    InputSettings settings[2];                  ///< Auto-repeat timing per player
+
+    uint8_t localInputs[INPUT_WINDOW];          ///< This side's buttons by tick % INPUT_WINDOW
+    uint8_t remoteInputs[INPUT_WINDOW];         ///< Other side's buttons by tick % INPUT_WINDOW
+    uint32_t nextLocalTick;                     ///< First tick without local buttons
+    uint32_t remoteReceived;                    ///< First tick without remote buttons (all earlier ones arrived)
+    uint32_t remoteAck;                         ///< First local tick the other side hasn't acknowledged
+    uint32_t nextTakeTick;                      ///< Next tick takeInputs() will hand out
+    bool localInputAdded;                       ///< New local buttons since the last send
+    bool ackPending;                            ///< Remote buttons arrived since the last send
+
+    Checksum localChecks[CHECKSUM_SLOTS];       ///< Our recent hashes
+    Checksum remoteChecks[CHECKSUM_SLOTS];      ///< Their recent hashes
+
+    sf::Clock lastSent;                         ///< Time since our last packet
+    sf::Clock lastReceived;                     ///< Time since their last packet
+    uint64_t bytesSent;                         ///< Payload bytes sent since connecting
+    uint64_t packetsSent;                       ///< Packets sent since connecting
+
+    void reset(int player);
+    void send(const uint8_t* data, size_t size);
+    void handlePacket(const uint8_t* data, size_t size);
+    void handleInputs(const uint8_t* data, size_t size);
+    void sendWelcome();
+    void compareChecksums();
+};
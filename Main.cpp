@@ -5,27 +5,490 @@
  * This file contains the main function that creates and runs the Tetris game.
  * The game uses SFML for graphics and input handling.
  *
+ * Command line options:
+ *   --seed <n>            Start with a fixed piece sequence seed
+ *   --record <file>       Save a replay of the session on exit
+ *   --replay <file>       Play a replay back in real time
+ *   --demo                Start in attract mode with the AI playing
+ *   --profile <file>      Save per-frame timings on exit (.json = percentile summary, else CSV)
+ *   --das <ticks>         Ticks a shift key is held before it repeats (default: 10)
+ *   --arr <ticks>         Ticks between repeated shifts, 0 = straight to the wall (default: 2)
+ *   --soft-drop <ticks>   Ticks between repeated soft drops, 0 = straight down (default: 2)
+ *   --smooth              Draw the falling piece sliding between rows
+ *   --pacing <mode>       Frame pacing: vsync, limit, uncapped or on-change (default: limit)
+ *   --fps <n>             Frame rate for the limit and on-change modes (default: 60)
+ *   --spin <us>           Microseconds before each frame the limiter spins instead of sleeping (default: 2000)
+ *   --no-music            Turn the procedural background music off
+ *   --mix-buffer <n>      Sound effect mixer buffer in samples; smaller = lower latency (default: 512)
+ *   --assets <file>       Asset pack to load the font and sounds from (default: assets.pak if present)
+ *   --pack <archive> <[name=]file...>  Build an asset pack (names default to the file name)
+ *   --rescore <files...>  Re-simulate replays at full speed without a window
+ *   --farm <games>        Play headless bot games on all cores (--seed sets the base seed)
+ *   --threads <n>         Worker threads for --farm (default: one per core)
+ *   --bot <random|search> Bot used by --farm (default: random)
+ *   --depth <n>           Pieces the --farm search bot looks ahead (default: 1)
+ *   --move-time <ms>      Time budget per move for the --farm search bot (default: none)
+ *   --versus-host [port]  Host a two-player versus match over UDP (default port: 47474)
+ *   --versus-join <address>[:port]  Join a versus match
+ *   --input-delay <ticks> Versus input delay chosen by the host (default: 3)
+ *   --versus-bot          Play the versus match with a headless bot instead of a window
+ *   --versus-ticks <n>    Ticks the --versus-bot match lasts at most (default: 3600)
+ *
  * @author Your Name
  * @date 2025
  */
 
 #include "Tetris.h"
+#include "SelfPlayFarm.h"
+#include <SFML/System/Sleep.hpp>
+#include <algorithm>
 #include <iostream>
-// This line should only be uncommented for the release version
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#endif
+
+// The release build is a windowed application, so no console opens behind the game
+#if defined(_MSC_VER) && defined(NDEBUG)
 #pragma comment(linker, "/SUBSYSTEM:WINDOWS /ENTRY:mainCRTStartup")
+#endif
+
+/**
+ * @brief Give the headless modes somewhere to print
+ *
+ * A windowed build starts without a console; this attaches to the one it was
+ * launched from, or opens a new one, and points the standard streams at it.
+ * Does nothing where the process already has a console.
+ */
+static void openConsole() {
+#ifdef _WIN32
+    if (GetConsoleWindow() != nullptr) return;
+    if (!AttachConsole(ATTACH_PARENT_PROCESS) && !AllocConsole()) return;
+
+    FILE* stream;
+    freopen_s(&stream, "CONOUT$", "w", stdout);
+    freopen_s(&stream, "CONOUT$", "w", stderr);
+    std::cout.clear();
+    std::cerr.clear();
+#endif
+}
+
+/**
+ * @brief Print command line usage
+ */
+static void printUsage() {
+    openConsole();
+    std::cout << "Usage: tetris [--seed <n>] [--record <file>] [--replay <file>] [--demo]" << std::endl;
+    std::cout << "              [--profile <file.csv|file.json>] [--das <ticks>] [--arr <ticks>]" << std::endl;
+    std::cout << "              [--soft-drop <ticks>] [--smooth] [--no-music] [--mix-buffer <samples>]" << std::endl;
+    std::cout << "              [--pacing vsync|limit|uncapped|on-change] [--fps <n>] [--spin <us>]" << std::endl;
+    std::cout << "              [--assets <file.pak>]" << std::endl;
+    std::cout << "       tetris --pack <archive> [<name>=]<file> [...]" << std::endl;
+    std::cout << "       tetris --rescore <file> [<file>...]" << std::endl;
+    std::cout << "       tetris --farm <games> [--threads <n>] [--bot random|search]" << std::endl;
+    std::cout << "                             [--depth <n>] [--move-time <ms>] [--seed <n>]" << std::endl;
+    std::cout << "       tetris --versus-host [<port>] [--input-delay <ticks>] [--seed <n>] [game options]" << std::endl;
+    std::cout << "       tetris --versus-join <address>[:<port>] [game options]" << std::endl;
+    std::cout << "              (add --versus-bot [--versus-ticks <n>] to either to play headless)" << std::endl;
+}
+
+/**
+ * @brief Build an asset pack from loose files
+ *
+ * @param archive Pack to write
+ * @param specs "name=path" or plain paths (stored under their file name); the
+ *              game looks for "font" and the sound file names, e.g. "move.wav"
+ * @return 0 on success, 1 otherwise
+ */
+static int packAssets(const std::string& archive, const std::vector<std::string>& specs) {
+    std::vector<PackSource> sources;
+    for (const auto& spec : specs) {
+        PackSource source;
+        size_t separator = spec.find('=');
+        if (separator != std::string::npos) {
+            source.name = spec.substr(0, separator);
+            source.path = spec.substr(separator + 1);
+        }
+        else {
+            source.path = spec;
+            source.name = spec.substr(spec.find_last_of("/\\") + 1);
+        }
+        sources.push_back(source);
+    }
+
+    std::string error;
+    if (!AssetPack::build(archive, sources, error)) {
+        std::cerr << "Could not build " << archive << ": " << error << std::endl;
+        return 1;
+    }
+
+    for (const auto& source : sources) {
+        std::cout << "  " << source.name << " <- " << source.path << std::endl;
+    }
+    std::cout << "Packed " << sources.size() << " files into " << archive << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Play a connected versus match with a headless bot, as fast as the link allows
+ *
+ * @param peer Connection to the other side
+ * @param maxTicks Ticks after which the match stops if no one has topped out
+ * @return 0 if the match ran to the end in sync, 1 otherwise
+ *
+ * The bot searches one piece ahead and taps one button at a time, waiting
+ * until the tap has been applied before planning the next one. Both sides
+ * print the same final hash if the lockstep held, which makes two bots on
+ * loopback an end-to-end test of the protocol.
+ */
+static int playVersusBot(LockstepPeer& peer, uint32_t maxTicks) {
+    TetrisEngine engines[VersusMatch::PLAYER_COUNT] = { TetrisEngine(peer.getSeed()), TetrisEngine(peer.getSeed()) };
+    VersusMatch match(engines[0], engines[1], peer.getSeed(), peer.getPlayerSettings(0), peer.getPlayerSettings(1));
+    const TetrisEngine& own = engines[peer.getLocalPlayer()];
+
+    TetrisAI ai;
+    int cooldown = 0;
+    bool tapped = false;
+    auto start = std::chrono::steady_clock::now();
+
+    while (match.getTick() < maxTicks && !match.isOver() && peer.isConnected()) {
+        peer.poll();
+
+        uint32_t tick = match.getTick();
+        if (peer.needsLocalInput(tick)) {
+            uint8_t keys = 0;
+            // A tap is a press for one byte and a release for the next; then wait until it has been applied
+            if (!tapped && cooldown == 0 && !own.isGameOver()) {
+                AIMove move = ai.findBestMove(own);
+                if (move.found && !move.path.empty()) {
+                    bool onlyDropsLeft = std::all_of(move.path.begin(), move.path.end(),
+                                                     [](Action action) { return action == Action::SoftDrop; });
+                    Action action = onlyDropsLeft ? Action::HardDrop : move.path.front();
+                    InputKey key = action == Action::MoveLeft ? InputKey::Left :
+                                   action == Action::MoveRight ? InputKey::Right :
+                                   action == Action::Rotate ? InputKey::Rotate :
+                                   action == Action::HardDrop ? InputKey::HardDrop : InputKey::SoftDrop;
+                    keys = VersusMatch::keyBit(key);
+                    tapped = true;
+                    cooldown = peer.getInputDelay() + 1;
+                }
+            }
+            else {
+                tapped = false;
+                cooldown = std::max(0, cooldown - 1);
+            }
+            peer.submitLocalInput(keys);
+        }
+
+        if (peer.hasInputs(tick)) {
+            uint8_t keys[VersusMatch::PLAYER_COUNT];
+            peer.takeInputs(tick, keys);
+            match.advance(keys);
+            if (match.getTick() % LockstepPeer::CHECK_INTERVAL == 0) {
+                peer.submitChecksum(match.getTick(), match.getHash());
+            }
+        }
+        else {
+            peer.flush();
+            sf::sleep(sf::milliseconds(1));
+            continue;
+        }
+        peer.flush();
+    }
+
+    // The other side may still be missing our last buttons; stay until they are acknowledged
+    sf::Clock lingering;
+    while (peer.isConnected() && !peer.allInputsAcknowledged() && lingering.getElapsedTime() < sf::seconds(2)) {
+        peer.poll();
+        peer.flush();
+        sf::sleep(sf::milliseconds(1));
+    }
+    // The other side says goodbye as soon as it is done, so only a match cut short means it left
+    bool opponentLeft = !match.isOver() && match.getTick() < maxTicks;
+    peer.disconnect();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    uint32_t ticks = std::max<uint32_t>(match.getTick(), 1);
+    std::cout << "Match ended at tick " << match.getTick() << " after " << elapsed.count() << "s: ";
+    if (match.isOver()) {
+        int winner = match.getWinner();
+        std::cout << (winner == VersusMatch::NO_WINNER ? std::string("draw") : "player " + std::to_string(winner + 1) + " wins");
+    }
+    else {
+        std::cout << (opponentLeft ? "opponent left" : "tick limit reached");
+    }
+    std::cout << std::endl;
+
+    for (int player = 0; player < VersusMatch::PLAYER_COUNT; player++) {
+        const TetrisEngine& engine = match.getEngine(player);
+        std::cout << "Player " << player + 1 << (player == peer.getLocalPlayer() ? " (you)" : "")
+                  << ": score " << engine.getScore() << ", lines " << engine.getLinesCleared()
+                  << ", garbage sent " << match.getGarbageSent(player) << std::endl;
+    }
+
+    char hash[32];
+    std::snprintf(hash, sizeof(hash), "%016llx", static_cast<unsigned long long>(match.getHash()));
+    std::cout << "Match hash: " << hash << std::endl;
+    std::cout << "Sent " << peer.getBytesSent() << " bytes in " << peer.getPacketsSent() << " packets ("
+              << static_cast<double>(peer.getBytesSent()) / ticks << " bytes per tick)" << std::endl;
+    std::cout << "Checksums: " << (peer.isDesynced() ? "MISMATCH" : "in sync") << std::endl;
+
+    return peer.isDesynced() || opponentLeft ? 1 : 0;
+}
+
+/**
+ * @brief Re-simulate replays at maximum speed with rendering off
+ *
+ * @param paths Replay files to score
+ * @return 0 if every replay loaded, 1 otherwise
+ */
+static int rescoreReplays(const std::vector<std::string>& paths) {
+    int status = 0;
+    auto start = std::chrono::steady_clock::now();
+
+    for (const auto& path : paths) {
+        Replay replay;
+        if (!replay.loadFromFile(path)) {
+            std::cerr << "Could not load replay: " << path << std::endl;
+            status = 1;
+            continue;
+        }
+
+        TetrisEngine engine(replay.getSeed());
+        ReplayPlayer player(replay);
+        player.runToEnd(engine);
+
+        std::cout << path << ": score " << engine.getScore()
+                  << ", lines " << engine.getLinesCleared()
+                  << ", level " << engine.getLevel()
+                  << ", ticks " << engine.getTickCount() << std::endl;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    std::cout << "Rescored " << paths.size() << " replays in " << elapsed.count() << "s" << std::endl;
+    return status;
+}
 
  /**
   * @brief Main entry point for the Tetris game
   *
-  * Creates a Tetris game instance and runs the main game loop.
+  * Parses the command line, then creates a Tetris game instance and runs the
+  * main game loop, or runs one of the headless modes (asset packing, replay rescoring, self-play farm).
   * Handles any exceptions that might occur during game execution.
   *
   * @return 0 on successful execution, non-zero on error
   */
-int main() {
+int main(int argc, char* argv[]) {
     try {
+        GameOptions options;
+        options.seed = static_cast<uint32_t>(std::chrono::steady_clock::now().time_since_epoch().count());  // Seed RNG with current time by default
+
+        Replay playback;
+        std::vector<std::string> rescorePaths;
+        std::string packPath;
+        std::vector<std::string> packSpecs;
+        FarmSettings farmSettings;
+        bool runFarm = false;
+        LockstepPeer versusPeer;
+        bool versusHost = false;
+        std::string versusAddress;
+        unsigned short versusPort = LockstepPeer::DEFAULT_PORT;
+        int inputDelay = LockstepPeer::DEFAULT_INPUT_DELAY;
+        bool versusBot = false;
+        uint32_t versusTicks = 3600;
+
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+
+            if (arg == "--seed" && i + 1 < argc) {
+                options.seed = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--record" && i + 1 < argc) {
+                options.recordPath = argv[++i];
+            }
+            else if (arg == "--replay" && i + 1 < argc) {
+                std::string path = argv[++i];
+                if (!playback.loadFromFile(path)) {
+                    std::cerr << "Error: Could not load replay: " << path << std::endl;
+                    return 1;
+                }
+                options.playback = &playback;
+            }
+            else if (arg == "--demo") {
+                options.demo = true;
+            }
+            else if (arg == "--profile" && i + 1 < argc) {
+                options.profilePath = argv[++i];
+            }
+            else if (arg == "--das" && i + 1 < argc) {
+                options.input.dasTicks = std::stoi(argv[++i]);
+            }
+            else if (arg == "--arr" && i + 1 < argc) {
+                options.input.arrTicks = std::stoi(argv[++i]);
+            }
+            else if (arg == "--soft-drop" && i + 1 < argc) {
+                options.input.softDropTicks = std::stoi(argv[++i]);
+            }
+            else if (arg == "--smooth") {
+                options.smoothFall = true;
+            }
+            else if (arg == "--no-music") {
+                options.music = false;
+            }
+            else if (arg == "--mix-buffer" && i + 1 < argc) {
+                options.mixerBufferFrames = std::stoi(argv[++i]);
+            }
+            else if (arg == "--pacing" && i + 1 < argc) {
+                if (!FramePacer::parseMode(argv[++i], options.pacing.mode)) {
+                    printUsage();
+                    return 1;
+                }
+            }
+            else if (arg == "--fps" && i + 1 < argc) {
+                options.pacing.targetFps = std::stoi(argv[++i]);
+            }
+            else if (arg == "--spin" && i + 1 < argc) {
+                options.pacing.spinWindowUs = std::stoi(argv[++i]);
+            }
+            else if (arg == "--assets" && i + 1 < argc) {
+                options.assetPack = argv[++i];
+            }
+            else if (arg == "--pack" && i + 1 < argc) {
+                packPath = argv[++i];
+                while (i + 1 < argc) {
+                    packSpecs.push_back(argv[++i]);
+                }
+            }
+            else if (arg == "--bot" && i + 1 < argc) {
+                std::string bot = argv[++i];
+                if (bot == "search") {
+                    farmSettings.bot = FarmBot::Search;
+                }
+                else if (bot == "random") {
+                    farmSettings.bot = FarmBot::Random;
+                }
+                else {
+                    printUsage();
+                    return 1;
+                }
+            }
+            else if (arg == "--depth" && i + 1 < argc) {
+                farmSettings.searchDepth = std::stoi(argv[++i]);
+            }
+            else if (arg == "--move-time" && i + 1 < argc) {
+                farmSettings.moveTimeUs = std::stoi(argv[++i]) * 1000;
+            }
+            else if (arg == "--farm" && i + 1 < argc) {
+                farmSettings.games = std::stoi(argv[++i]);
+                runFarm = true;
+            }
+            else if (arg == "--threads" && i + 1 < argc) {
+                farmSettings.threads = std::stoi(argv[++i]);
+            }
+            else if (arg == "--versus-host") {
+                versusHost = true;
+                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                    versusPort = static_cast<unsigned short>(std::stoi(argv[++i]));
+                }
+            }
+            else if (arg == "--versus-join" && i + 1 < argc) {
+                versusAddress = argv[++i];
+                size_t colon = versusAddress.rfind(':');
+                if (colon != std::string::npos) {
+                    versusPort = static_cast<unsigned short>(std::stoi(versusAddress.substr(colon + 1)));
+                    versusAddress.erase(colon);
+                }
+            }
+            else if (arg == "--input-delay" && i + 1 < argc) {
+                inputDelay = std::stoi(argv[++i]);
+            }
+            else if (arg == "--versus-bot") {
+                versusBot = true;
+            }
+            else if (arg == "--versus-ticks" && i + 1 < argc) {
+                versusTicks = static_cast<uint32_t>(std::stoul(argv[++i]));
+            }
+            else if (arg == "--rescore") {
+                while (i + 1 < argc) {
+                    rescorePaths.push_back(argv[++i]);
+                }
+            }
+            else {
+                printUsage();
+                return 1;
+            }
+        }
+
+        if (!packPath.empty() || !rescorePaths.empty() || runFarm || versusBot) {
+            openConsole();
+        }
+
+        // Asset packing tool - no window or audio device needed
+        if (!packPath.empty()) {
+            return packAssets(packPath, packSpecs);
+        }
+
+        // Headless replay scoring - no window or audio device needed
+        if (!rescorePaths.empty()) {
+            return rescoreReplays(rescorePaths);
+        }
+
+        // Headless self-play batch
+        if (runFarm) {
+            farmSettings.baseSeed = options.seed;
+            std::cout << "Base seed: " << farmSettings.baseSeed << std::endl;
+
+            SelfPlayFarm farm(farmSettings);
+            farm.run();
+            farm.printSummary(std::cout);
+            return 0;
+        }
+
+        // Versus - connect first, then play headless or in the window with the shared seed
+        if (versusHost || !versusAddress.empty()) {
+            if (options.playback || !options.recordPath.empty() || options.demo) {
+                std::cerr << "Error: --replay, --record and --demo can't be combined with a versus match" << std::endl;
+                return 1;
+            }
+
+            std::string error;
+            bool connected;
+            if (versusHost) {
+                std::cout << "Waiting for an opponent on UDP port " << versusPort << "..." << std::endl;
+                connected = versusPeer.host(versusPort, options.seed, inputDelay, options.input, sf::seconds(120), error);
+            }
+            else {
+                std::cout << "Joining " << versusAddress << ":" << versusPort << "..." << std::endl;
+                connected = versusPeer.join(sf::IpAddress(versusAddress), versusPort, options.input, sf::seconds(30), error);
+            }
+            if (!connected) {
+                std::cerr << "Error: " << error << std::endl;
+                return 1;
+            }
+            std::cout << "Connected as player " << versusPeer.getLocalPlayer() + 1 << " (seed " << versusPeer.getSeed()
+                      << ", input delay " << versusPeer.getInputDelay() << " ticks)" << std::endl;
+
+            if (versusBot) {
+                return playVersusBot(versusPeer, versusTicks);
+            }
+            options.seed = versusPeer.getSeed();
+            options.versus = &versusPeer;
+        }
+
+        std::cout << "Seed: " << (options.playback ? playback.getSeed() : options.seed) << std::endl;
+
         // Create and run the Tetris game
-        Tetris game;
+        Tetris game(options);
         game.run();
 
         std::cout << "Game ended successfully." << std::endl;
@@ -41,4 +504,4 @@ int main() {
         std::cerr << "Unknown error occurred." << std::endl;
         return 1;
     }
-}
\ No newline at end of file
+}
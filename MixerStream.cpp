@@ -0,0 +1,32 @@
+#include "MixerStream.h"
+#include <algorithm>
+
+/**
+ * Constructor - Size the buffer and match the streaming thread's polling to it
+ */
+MixerStream::MixerStream(SoundMixer& mixer, int bufferFrames) :
+    mixer(mixer),
+    buffer(std::max(static_cast<int>(MIN_BUFFER_FRAMES), std::min(bufferFrames, static_cast<int>(SoundMixer::MAX_BLOCK_FRAMES))))
+{
+    initialize(1, SoundMixer::SAMPLE_RATE);
+
+    sf::Int64 bufferUs = static_cast<sf::Int64>(buffer.size()) * 1000000 / SoundMixer::SAMPLE_RATE;
+    setProcessingInterval(sf::microseconds(std::max<sf::Int64>(bufferUs / 4, 1000)));
+}
+
+MixerStream::~MixerStream() {
+    stop();
+}
+
+bool MixerStream::onGetData(Chunk& data) {
+    mixer.mix(buffer.data(), static_cast<int>(buffer.size()));
+    data.samples = buffer.data();
+    data.sampleCount = buffer.size();
+    return true;  // Silence between effects, never the end of the stream
+}
+
+/**
+ * Live output has no timeline to seek in
+ */
+void MixerStream::onSeek(sf::Time) {
+}
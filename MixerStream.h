@@ -0,0 +1,44 @@
+#pragma once
+
+#include "SoundMixer.h"
+#include <SFML/Audio/SoundStream.hpp>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Plays a SoundMixer through a single sf::SoundStream
+ *
+ * SFML keeps three buffers of bufferFrames samples queued on the stream's
+ * OpenAL source and refills one from SoundMixer::mix() on its streaming
+ * thread whenever one finishes, so a play() issued by the game reaches the
+ * speakers within about three buffers. The streaming thread is asked to
+ * check for finished buffers four times per buffer so small buffers don't
+ * run dry between checks.
+ */
+class MixerStream : public sf::SoundStream {
+public:
+    static const int DEFAULT_BUFFER_FRAMES = 512;  ///< About 12 ms per buffer
+    static const int MIN_BUFFER_FRAMES = 64;    ///< Smallest buffer accepted
+
+    /**
+     * @brief Constructor
+     *
+     * @param mixer Mixer to pull from; must outlive the stream
+     * @param bufferFrames Samples per buffer, clamped to MIN_BUFFER_FRAMES..SoundMixer::MAX_BLOCK_FRAMES
+     */
+    explicit MixerStream(SoundMixer& mixer, int bufferFrames = DEFAULT_BUFFER_FRAMES);
+
+    /**
+     * @brief Stops the stream before the buffer its thread fills is destroyed
+     */
+    ~MixerStream();
+
+    int getBufferFrames() const { return static_cast<int>(buffer.size()); }
+
+private:
+    SoundMixer& mixer;                          ///< Source of the samples
+    std::vector<int16_t> buffer;                ///< Block handed to SFML (allocated once)
+
+    bool onGetData(Chunk& data) override;
+    void onSeek(sf::Time timeOffset) override;
+};
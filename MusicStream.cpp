@@ -0,0 +1,162 @@
+#include "MusicStream.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace {
+    const int CHORD_COUNT = 4;
+    const int CHORD_ROOTS[CHORD_COUNT] = { 57, 53, 48, 55 };           // A3, F3, C3, G3 (MIDI)
+    const int CHORD_TONES[CHORD_COUNT][4] = {
+        { 0, 3, 7, 12 },                        // Am
+        { 0, 4, 7, 12 },                        // F
+        { 0, 4, 7, 12 },                        // C
+        { 0, 4, 7, 12 }                         // G
+    };
+
+    const float BASE_TEMPO = 96.0f;             // Beats per minute at level 1
+    const float TEMPO_PER_LEVEL = 6.0f;
+    const float MAX_TEMPO = 180.0f;
+    const int DANGER_HEIGHT = 16;               // Stack height at which intensity reaches 1
+
+    const float BASS_DECAY_SECONDS = 0.35f;     // Time for each voice to fall to 1/e
+    const float LEAD_DECAY_SECONDS = 0.12f;
+    const float HAT_DECAY_SECONDS = 0.025f;
+    const float OUTPUT_GAIN = 0.5f * 32767.0f;
+
+    float decayPerSample(float seconds) {
+        return std::exp(-1.0f / (seconds * MusicStream::SAMPLE_RATE));
+    }
+}
+
+/**
+ * Constructor - Allocate the output block and start at level 1 with an empty board
+ */
+MusicStream::MusicStream() :
+    tempo(BASE_TEMPO),
+    intensity(0),
+    lastBufferUs(0),
+    peakBufferUs(0),
+    buffer(BUFFER_SAMPLES),
+    samplesUntilStep(0),
+    step(-1),
+    bass(),
+    lead(),
+    hat(),
+    noise(0x9E3779B9u)
+{
+    bass.decay = decayPerSample(BASS_DECAY_SECONDS);
+    lead.decay = decayPerSample(LEAD_DECAY_SECONDS);
+    hat.decay = decayPerSample(HAT_DECAY_SECONDS);
+    initialize(1, SAMPLE_RATE);
+}
+
+MusicStream::~MusicStream() {
+    stop();
+}
+
+void MusicStream::setGameState(int level, int stackHeight, bool gameOver) {
+    float bpm = std::min(BASE_TEMPO + (level - 1) * TEMPO_PER_LEVEL, MAX_TEMPO);
+    float level01 = gameOver ? 0.0f : std::min(static_cast<float>(stackHeight) / DANGER_HEIGHT, 1.0f);
+    tempo.store(bpm, std::memory_order_relaxed);
+    intensity.store(level01, std::memory_order_relaxed);
+}
+
+MusicLoad MusicStream::takeLoad() {
+    MusicLoad load;
+    load.lastUs = lastBufferUs.load(std::memory_order_relaxed);
+    load.peakUs = peakBufferUs.exchange(0, std::memory_order_relaxed);
+    load.bufferUs = BUFFER_SAMPLES * 1e6f / SAMPLE_RATE;
+    return load;
+}
+
+/**
+ * Synthesise one block: advance the sequencer and sum the three voices sample by sample
+ */
+bool MusicStream::onGetData(Chunk& data) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < BUFFER_SAMPLES; i++) {
+        if (samplesUntilStep <= 0) {
+            startStep();
+            // Tempo is read once per step so a change lands on the beat
+            float bpm = tempo.load(std::memory_order_relaxed);
+            samplesUntilStep += SAMPLE_RATE * 60.0f / (bpm * 4);
+        }
+        samplesUntilStep -= 1;
+
+        // Triangle bass
+        float bassWave = 4.0f * std::fabs(bass.phase - 0.5f) - 1.0f;
+        bass.phase += bass.increment;
+        bass.phase -= std::floor(bass.phase);
+        bass.envelope *= bass.decay;
+
+        // Lead: triangle with a little square for bite
+        float leadTriangle = 4.0f * std::fabs(lead.phase - 0.5f) - 1.0f;
+        float leadSquare = lead.phase < 0.5f ? 1.0f : -1.0f;
+        lead.phase += lead.increment;
+        lead.phase -= std::floor(lead.phase);
+        lead.envelope *= lead.decay;
+
+        // Hi-hat: white noise from a xorshift generator
+        noise ^= noise << 13;
+        noise ^= noise >> 17;
+        noise ^= noise << 5;
+        float hatWave = static_cast<float>(noise) * (2.0f / 4294967296.0f) - 1.0f;
+        hat.envelope *= hat.decay;
+
+        float mix = bassWave * bass.envelope
+                  + (0.75f * leadTriangle + 0.25f * leadSquare) * lead.envelope
+                  + hatWave * hat.envelope;
+        buffer[i] = static_cast<int16_t>(std::max(-1.0f, std::min(mix, 1.0f)) * OUTPUT_GAIN);
+    }
+
+    data.samples = buffer.data();
+    data.sampleCount = buffer.size();
+
+    float elapsedUs = std::chrono::duration<float, std::micro>(std::chrono::steady_clock::now() - start).count();
+    lastBufferUs.store(elapsedUs, std::memory_order_relaxed);
+    float peak = peakBufferUs.load(std::memory_order_relaxed);
+    while (elapsedUs > peak && !peakBufferUs.compare_exchange_weak(peak, elapsedUs, std::memory_order_relaxed)) {
+    }
+    return true;  // Endless
+}
+
+/**
+ * Music has no timeline; seeking (and the rewind on play) just restarts the progression
+ */
+void MusicStream::onSeek(sf::Time) {
+    samplesUntilStep = 0;
+    step = -1;
+}
+
+/**
+ * Denser patterns as intensity rises: the bass doubles up, the arpeggio fills
+ * in from quarter notes to sixteenths and the hi-hat joins
+ */
+void MusicStream::startStep() {
+    step = (step + 1) % (STEPS_PER_BAR * CHORD_COUNT);
+    int chord = step / STEPS_PER_BAR;
+    int beatStep = step % STEPS_PER_BAR;
+    float level01 = intensity.load(std::memory_order_relaxed);
+
+    int bassEvery = level01 > 0.5f ? 4 : 8;
+    if (beatStep % bassEvery == 0) {
+        trigger(bass, CHORD_ROOTS[chord] - 12, 0.45f);
+    }
+
+    int leadEvery = level01 > 0.65f ? 1 : level01 > 0.3f ? 2 : 4;
+    if (beatStep % leadEvery == 0) {
+        int tone = CHORD_TONES[chord][(beatStep / leadEvery) % 4];
+        trigger(lead, CHORD_ROOTS[chord] + 12 + tone, 0.18f + 0.12f * level01);
+    }
+
+    if (level01 > 0.4f && (beatStep % 2 == 1 || level01 > 0.8f)) {
+        hat.envelope = 0.06f + 0.04f * level01;
+    }
+}
+
+void MusicStream::trigger(Voice& voice, int midiNote, float amplitude) {
+    float frequency = 440.0f * std::pow(2.0f, (midiNote - 69) / 12.0f);
+    voice.increment = frequency / SAMPLE_RATE;
+    voice.envelope = amplitude;
+}
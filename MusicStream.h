@@ -0,0 +1,96 @@
+#pragma once
+
+#include <SFML/Audio/SoundStream.hpp>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Time the audio thread spends synthesising music, per buffer
+ */
+struct MusicLoad {
+    float lastUs;                               ///< Synthesis time of the latest buffer
+    float peakUs;                               ///< Longest synthesis time since the previous takeLoad()
+    float bufferUs;                             ///< Playback length of one buffer (the time budget)
+};
+
+/**
+ * @brief Procedural background music streamed from the audio thread
+ *
+ * A 16-step sequencer loops an Am-F-C-G progression with a triangle bass, a
+ * plucked arpeggio and a noise hi-hat. The game pushes its state with
+ * setGameState(): the level sets the tempo and the height of the stack sets
+ * the intensity, which fills in the arpeggio and hi-hat patterns as the
+ * board gets dangerous.
+ *
+ * onGetData runs on SFML's streaming thread and synthesises one buffer per
+ * call into storage allocated up front. The game state arrives through
+ * relaxed atomics, so neither side ever waits for the other, and nothing in
+ * the callback allocates or locks. Each callback's duration is recorded for
+ * the frame stats overlay.
+ */
+class MusicStream : public sf::SoundStream {
+public:
+    static const unsigned SAMPLE_RATE = 44100;  ///< Output sample rate (mono)
+    static const int BUFFER_SAMPLES = 2048;     ///< Samples synthesised per callback (about 46 ms)
+    static const int STEPS_PER_BAR = 16;        ///< Sequencer steps (sixteenth notes) per chord
+
+    MusicStream();
+
+    /**
+     * @brief Stops the stream before the members its thread reads are destroyed
+     */
+    ~MusicStream();
+
+    /**
+     * @brief Push the game state that drives tempo and intensity (any thread)
+     *
+     * @param level Current level (tempo rises with it)
+     * @param stackHeight Height of the tallest column in rows
+     * @param gameOver Whether the game is over (drops back to the calmest pattern)
+     */
+    void setGameState(int level, int stackHeight, bool gameOver);
+
+    /**
+     * @brief Synthesis cost of the latest buffer and the peak since the previous call (one reader only)
+     */
+    MusicLoad takeLoad();
+
+private:
+    /**
+     * @brief A decaying oscillator
+     */
+    struct Voice {
+        float phase;                            ///< Position in the cycle, 0 to 1
+        float increment;                        ///< Phase advance per sample (frequency / sample rate)
+        float envelope;                         ///< Current amplitude
+        float decay;                            ///< Envelope multiplier per sample
+    };
+
+    // Written by the game, read by the audio thread
+    std::atomic<float> tempo;                   ///< Beats per minute
+    std::atomic<float> intensity;               ///< 0 = calm, 1 = stack near the top
+
+    // Written by the audio thread, read by the overlay
+    std::atomic<float> lastBufferUs;            ///< Synthesis time of the latest buffer
+    std::atomic<float> peakBufferUs;            ///< Longest synthesis time not taken yet
+
+    // ---- Owned by the audio thread ----
+    std::vector<int16_t> buffer;                ///< Output block (allocated once)
+    float samplesUntilStep;                     ///< Samples left in the current step
+    int step;                                   ///< Step within the whole progression
+    Voice bass;                                 ///< Triangle bass
+    Voice lead;                                 ///< Plucked arpeggio
+    Voice hat;                                  ///< Noise hi-hat (phase unused)
+    uint32_t noise;                             ///< Xorshift state for the hi-hat
+
+    bool onGetData(Chunk& data) override;
+    void onSeek(sf::Time timeOffset) override;
+
+    /**
+     * @brief Trigger the notes of the step that is starting
+     */
+    void startStep();
+
+    static void trigger(Voice& voice, int midiNote, float amplitude);
+};
@@ -0,0 +1,159 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief One rotation of a tetromino, precomputed at compile time
+ *
+ * Cells live in a 4x4 grid; bit (py * 4 + px) of mask is set when the
+ * cell at column px, row py is occupied. The per-row masks and bounding
+ * box let collision checks skip empty rows and reject wall hits without
+ * touching the board.
+ */
+struct PieceShape {
+    uint16_t mask;      ///< Occupied cells of the 4x4 grid
+    uint8_t rows[4];    ///< Occupancy bitmask of each grid row (bit px = column px)
+    int8_t minX;        ///< Leftmost occupied column
+    int8_t maxX;        ///< Rightmost occupied column
+    int8_t minY;        ///< Topmost occupied row
+    int8_t maxY;        ///< Bottommost occupied row
+};
+
+/**
+ * @brief Position and orientation of the falling piece
+ *
+ * Trivially copyable so that engine snapshots and search nodes can copy it freely.
+ */
+struct ActivePiece {
+    int type;           ///< Piece type index (0-6)
+    int rotation;       ///< Rotation index (0-3), clockwise from spawn orientation
+    int x;              ///< X position of the 4x4 grid on the board
+    int y;              ///< Y position of the 4x4 grid on the board
+};
+
+namespace PieceTable {
+    constexpr int PIECE_COUNT = 7;              ///< Number of tetromino types
+    constexpr int ROTATION_COUNT = 4;           ///< Number of orientations per piece
+
+    /**
+     * @brief Build a 4x4 cell mask from four rows of text ('#' = occupied)
+     */
+    constexpr uint16_t maskFromRows(const char* r0, const char* r1, const char* r2, const char* r3) {
+        const char* grid[4] = { r0, r1, r2, r3 };
+        uint16_t mask = 0;
+        for (int py = 0; py < 4; py++) {
+            for (int px = 0; px < 4; px++) {
+                if (grid[py][px] == '#') {
+                    mask |= static_cast<uint16_t>(1u << (py * 4 + px));
+                }
+            }
+        }
+        return mask;
+    }
+
+    /**
+     * @brief Rotate a 4x4 cell mask 90 degrees clockwise: (x,y) -> (3-y, x)
+     */
+    constexpr uint16_t rotateMask(uint16_t mask) {
+        uint16_t rotated = 0;
+        for (int py = 0; py < 4; py++) {
+            for (int px = 0; px < 4; px++) {
+                if (mask & (1u << (py * 4 + px))) {
+                    rotated |= static_cast<uint16_t>(1u << (px * 4 + (3 - py)));
+                }
+            }
+        }
+        return rotated;
+    }
+
+    /**
+     * @brief Derive row masks and bounding box for a cell mask
+     */
+    constexpr PieceShape makeShape(uint16_t mask) {
+        PieceShape shape = { mask, { 0, 0, 0, 0 }, 4, -1, 4, -1 };
+        for (int py = 0; py < 4; py++) {
+            shape.rows[py] = static_cast<uint8_t>((mask >> (py * 4)) & 0xF);
+            for (int px = 0; px < 4; px++) {
+                if (mask & (1u << (py * 4 + px))) {
+                    if (px < shape.minX) shape.minX = static_cast<int8_t>(px);
+                    if (px > shape.maxX) shape.maxX = static_cast<int8_t>(px);
+                    if (py < shape.minY) shape.minY = static_cast<int8_t>(py);
+                    if (py > shape.maxY) shape.maxY = static_cast<int8_t>(py);
+                }
+            }
+        }
+        return shape;
+    }
+
+    /**
+     * @brief Spawn orientation of every piece, indexed by piece type
+     */
+    inline constexpr uint16_t SPAWN_MASKS[PIECE_COUNT] = {
+        // I-piece (cyan) - straight line piece
+        maskFromRows("....",
+                     "####",
+                     "....",
+                     "...."),
+        // O-piece (yellow) - square piece
+        maskFromRows("....",
+                     ".##.",
+                     ".##.",
+                     "...."),
+        // T-piece (purple) - T-shaped piece
+        maskFromRows("....",
+                     ".#..",
+                     "###.",
+                     "...."),
+        // S-piece (green) - S-shaped piece
+        maskFromRows("....",
+                     ".##.",
+                     "##..",
+                     "...."),
+        // Z-piece (red) - Z-shaped piece
+        maskFromRows("....",
+                     "##..",
+                     ".##.",
+                     "...."),
+        // J-piece (blue) - J-shaped piece
+        maskFromRows("....",
+                     "#...",
+                     "###.",
+                     "...."),
+        // L-piece (orange) - L-shaped piece
+        maskFromRows("....",
+                     "..#.",
+                     "###.",
+                     "....")
+    };
+
+    /**
+     * @brief All pieces in all rotations
+     */
+    struct ShapeSet {
+        PieceShape shapes[PIECE_COUNT][ROTATION_COUNT];
+    };
+
+    constexpr ShapeSet buildShapes() {
+        ShapeSet set = {};
+        for (int type = 0; type < PIECE_COUNT; type++) {
+            uint16_t mask = SPAWN_MASKS[type];
+            for (int rotation = 0; rotation < ROTATION_COUNT; rotation++) {
+                set.shapes[type][rotation] = makeShape(mask);
+                mask = rotateMask(mask);
+            }
+        }
+        return set;
+    }
+
+    inline constexpr ShapeSet SHAPES = buildShapes();  ///< Generated rotation table
+
+    /**
+     * @brief Look up the precomputed shape for a piece type and rotation
+     */
+    constexpr const PieceShape& shape(int type, int rotation) {
+        return SHAPES.shapes[type][rotation];
+    }
+
+    static_assert(rotateMask(rotateMask(rotateMask(rotateMask(SPAWN_MASKS[2])))) == SPAWN_MASKS[2],
+                  "four clockwise rotations must return to the spawn orientation");
+}
@@ -0,0 +1,199 @@
+#include "Replay.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+
+namespace {
+    const char MAGIC[4] = { 'T', 'R', 'P', 'L' };
+    const int ACTION_BITS = 3;                  ///< Bits used for the action in each packed input
+
+    /**
+     * Append an unsigned LEB128 varint
+     */
+    void writeVarint(std::vector<uint8_t>& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    /**
+     * Read an unsigned LEB128 varint, advancing pos; false if truncated
+     */
+    bool readVarint(const std::vector<uint8_t>& in, size_t& pos, uint64_t& value) {
+        value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            if (pos >= in.size()) return false;
+            uint8_t byte = in[pos++];
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) return true;
+        }
+        return false;
+    }
+}
+
+const uint8_t Replay::FORMAT_VERSION;
+
+/**
+ * Constructor - Empty replay for the given seed
+ */
+Replay::Replay(uint32_t seed) :
+    seed(seed),
+    length(0)
+{
+}
+
+/**
+ * Append a tick-stamped action
+ */
+void Replay::record(uint64_t tick, Action action) {
+    inputs.push_back({ static_cast<uint32_t>(tick), action });
+}
+
+/**
+ * Set the recording length
+ */
+void Replay::finish(uint64_t tick) {
+    length = static_cast<uint32_t>(tick);
+}
+
+/**
+ * Encode header and delta-coded inputs
+ */
+std::vector<uint8_t> Replay::serialize() const {
+    std::vector<uint8_t> out(MAGIC, MAGIC + 4);
+    out.push_back(FORMAT_VERSION);
+    for (int i = 0; i < 4; i++) {
+        out.push_back(static_cast<uint8_t>(seed >> (i * 8)));
+    }
+
+    writeVarint(out, length);
+    writeVarint(out, inputs.size());
+
+    uint32_t previousTick = 0;
+    for (const auto& input : inputs) {
+        uint64_t delta = input.tick - previousTick;
+        writeVarint(out, (delta << ACTION_BITS) | static_cast<uint64_t>(input.action));
+        previousTick = input.tick;
+    }
+    return out;
+}
+
+/**
+ * Decode header and inputs, validating as we go
+ */
+bool Replay::deserialize(const std::vector<uint8_t>& data) {
+    if (data.size() < 9 || !std::equal(MAGIC, MAGIC + 4, data.begin()) || data[4] != FORMAT_VERSION) {
+        return false;
+    }
+
+    uint32_t newSeed = 0;
+    for (int i = 0; i < 4; i++) {
+        newSeed |= static_cast<uint32_t>(data[5 + i]) << (i * 8);
+    }
+
+    size_t pos = 9;
+    uint64_t newLength = 0;
+    uint64_t count = 0;
+    if (!readVarint(data, pos, newLength) || !readVarint(data, pos, count)) {
+        return false;
+    }
+
+    std::vector<ReplayInput> newInputs;
+    newInputs.reserve(static_cast<size_t>(std::min<uint64_t>(count, data.size())));
+
+    uint64_t tick = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t packed = 0;
+        if (!readVarint(data, pos, packed)) return false;
+
+        uint64_t action = packed & ((1u << ACTION_BITS) - 1);
+        if (action > static_cast<uint64_t>(Action::Restart)) return false;
+
+        tick += packed >> ACTION_BITS;
+        newInputs.push_back({ static_cast<uint32_t>(tick), static_cast<Action>(action) });
+    }
+
+    seed = newSeed;
+    length = static_cast<uint32_t>(newLength);
+    inputs.swap(newInputs);
+    return true;
+}
+
+/**
+ * Write the encoded replay to disk
+ */
+bool Replay::saveToFile(const std::string& path) const {
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::vector<uint8_t> data = serialize();
+    file.write(reinterpret_cast<const char*>(data.data()), data.size());
+    return static_cast<bool>(file);
+}
+
+/**
+ * Read and decode a replay from disk
+ */
+bool Replay::loadFromFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) return false;
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return deserialize(data);
+}
+
+/**
+ * Constructor - Start playback at the first input
+ */
+ReplayPlayer::ReplayPlayer(const Replay& replay) :
+    replay(replay),
+    nextInput(0)
+{
+}
+
+/**
+ * Apply the inputs recorded for the engine's current tick
+ */
+void ReplayPlayer::applyInputs(TetrisEngine& engine) {
+    const auto& inputs = replay.getInputs();
+    uint64_t tick = engine.getTickCount();
+
+    while (nextInput < inputs.size() && inputs[nextInput].tick <= tick) {
+        engine.step(inputs[nextInput].action);
+        nextInput++;
+    }
+}
+
+/**
+ * Replay one tick
+ */
+void ReplayPlayer::advance(TetrisEngine& engine) {
+    if (isFinished(engine)) return;
+
+    applyInputs(engine);
+    engine.tick();
+
+    // Inputs recorded after the final tick still belong to the game
+    if (isFinished(engine)) {
+        applyInputs(engine);
+    }
+}
+
+/**
+ * Replay all remaining ticks
+ */
+void ReplayPlayer::runToEnd(TetrisEngine& engine) {
+    while (!isFinished(engine)) {
+        advance(engine);
+    }
+    applyInputs(engine);
+}
+
+/**
+ * Check whether the recorded length has been reached
+ */
+bool ReplayPlayer::isFinished(const TetrisEngine& engine) const {
+    return engine.getTickCount() >= replay.getLength();
+}
@@ -0,0 +1,126 @@
+#pragma once
+
+#include "TetrisEngine.h"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief One recorded player action
+ */
+struct ReplayInput {
+    uint32_t tick;                              ///< Engine tick count when the action was applied
+    Action action;                              ///< The action that was applied
+};
+
+/**
+ * @brief Seed plus tick-stamped inputs of a game, with a compact binary format
+ *
+ * A replay holds everything needed to reproduce a game exactly: the engine
+ * seed, every accepted action with the tick it was applied on, and the tick
+ * the recording stopped at.
+ *
+ * File layout (all integers little endian, "varint" = LEB128):
+ *   "TRPL" magic, 1 byte version, 4 byte seed,
+ *   varint length in ticks, varint input count,
+ *   then per input varint((ticks since previous input << 3) | action).
+ * A typical input costs one or two bytes.
+ */
+class Replay {
+public:
+    static const uint8_t FORMAT_VERSION = 1;    ///< Version written to the file header
+
+    /**
+     * @brief Constructor - creates an empty replay
+     *
+     * @param seed Seed of the engine being recorded
+     */
+    explicit Replay(uint32_t seed = 0);
+
+    /**
+     * @brief Append an action applied at the given tick
+     *
+     * @param tick Engine tick count when the action was applied (must not decrease)
+     * @param action The action that was applied
+     */
+    void record(uint64_t tick, Action action);
+
+    /**
+     * @brief Mark the tick at which the recording ends
+     */
+    void finish(uint64_t tick);
+
+    /**
+     * @brief Encode the replay into the binary format
+     */
+    std::vector<uint8_t> serialize() const;
+
+    /**
+     * @brief Decode a replay from the binary format
+     *
+     * @return false if the data is truncated or not a replay
+     */
+    bool deserialize(const std::vector<uint8_t>& data);
+
+    /**
+     * @brief Write the replay to a file
+     *
+     * @return true on success
+     */
+    bool saveToFile(const std::string& path) const;
+
+    /**
+     * @brief Read a replay from a file
+     *
+     * @return true on success
+     */
+    bool loadFromFile(const std::string& path);
+
+    uint32_t getSeed() const { return seed; }
+    uint32_t getLength() const { return length; }
+    const std::vector<ReplayInput>& getInputs() const { return inputs; }
+
+private:
+    uint32_t seed;                              ///< Engine seed
+    uint32_t length;                            ///< Number of ticks covered by the recording
+    std::vector<ReplayInput> inputs;            ///< Recorded inputs in tick order
+};
+
+/**
+ * @brief Drives a TetrisEngine from a recorded replay
+ *
+ * The engine must be freshly created with the replay's seed, since input
+ * ticks are absolute engine tick counts. Call advance() instead of
+ * TetrisEngine::tick(); it applies the inputs recorded for the current tick
+ * and then ticks the engine.
+ */
+class ReplayPlayer {
+public:
+    explicit ReplayPlayer(const Replay& replay);
+
+    /**
+     * @brief Apply this tick's recorded inputs and advance the engine one tick
+     *
+     * Does nothing once the replay is finished.
+     */
+    void advance(TetrisEngine& engine);
+
+    /**
+     * @brief Run the rest of the replay as fast as possible
+     */
+    void runToEnd(TetrisEngine& engine);
+
+    /**
+     * @brief Whether every recorded tick has been played
+     */
+    bool isFinished(const TetrisEngine& engine) const;
+
+private:
+    const Replay& replay;                       ///< Replay being played
+    size_t nextInput;                           ///< Index of the next input to apply
+
+    /**
+     * @brief Apply every input recorded for the engine's current tick
+     */
+    void applyInputs(TetrisEngine& engine);
+};
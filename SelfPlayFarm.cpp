@@ -0,0 +1,150 @@
+#include "SelfPlayFarm.h"
+#include "WorkStealingPool.h"
+#include "TetrisAI.h"
+#include <chrono>
+#include <random>
+#include <ostream>
+#include <cstdlib>
+
+namespace {
+    /**
+     * Play one piece at a random rotation and column, then lock it
+     */
+    void playRandomPiece(TetrisEngine& engine, std::mt19937& rng) {
+        int rotations = static_cast<int>(rng() % PieceTable::ROTATION_COUNT);
+        int shift = static_cast<int>(rng() % TetrisEngine::BOARD_WIDTH) - TetrisEngine::BOARD_WIDTH / 2;
+
+        for (int i = 0; i < rotations; i++) {
+            engine.step(Action::Rotate);
+        }
+        for (int i = 0; i < std::abs(shift); i++) {
+            if (!engine.step(shift < 0 ? Action::MoveLeft : Action::MoveRight)) break;
+        }
+
+        engine.step(Action::HardDrop);
+        engine.gravityStep();  // Lock immediately instead of waiting for the drop interval
+    }
+}
+
+/**
+ * Constructor - Store settings; results are sized when the farm runs
+ */
+SelfPlayFarm::SelfPlayFarm(const FarmSettings& settings) :
+    settings(settings),
+    elapsedSeconds(0)
+{
+}
+
+/**
+ * Mix the base seed and game index (splitmix64 finalizer) into a game seed
+ */
+uint32_t SelfPlayFarm::gameSeed(uint32_t baseSeed, int gameIndex) {
+    uint64_t z = (static_cast<uint64_t>(baseSeed) << 32) + static_cast<uint64_t>(gameIndex) + 0x9E3779B97F4A7C15ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return static_cast<uint32_t>(z ^ (z >> 31));
+}
+
+/**
+ * Play one game until it tops out or reaches the piece limit
+ */
+GameResult SelfPlayFarm::playGame(uint32_t seed, const FarmSettings& settings, TranspositionTable* table) {
+    auto start = std::chrono::steady_clock::now();
+
+    TetrisEngine engine(seed);
+    std::mt19937 botRng(seed ^ 0x5BD1E995u);  // Bot decisions are seeded from the game too
+    TetrisAI ai(HeuristicWeights(), table);
+    SearchLimits limits;
+    limits.maxDepth = settings.searchDepth;
+    limits.timeBudgetUs = settings.moveTimeUs;
+    long long depthSum = 0;
+    int searches = 0;
+
+    while (!engine.isGameOver() && engine.getPiecesPlaced() < settings.maxPieces) {
+        switch (settings.bot) {
+        case FarmBot::Search:
+            TetrisAI::applyMove(engine, ai.findBestMove(engine, limits));
+            depthSum += ai.getLastStats().depth;
+            searches++;
+            break;
+
+        case FarmBot::Random:
+        default:
+            playRandomPiece(engine, botRng);
+            break;
+        }
+    }
+
+    std::chrono::duration<double, std::milli> duration = std::chrono::steady_clock::now() - start;
+    double averageDepth = searches > 0 ? static_cast<double>(depthSum) / searches : 0;
+    return { seed, engine.getScore(), engine.getLinesCleared(), engine.getLevel(),
+             engine.getPiecesPlaced(), duration.count(), averageDepth };
+}
+
+/**
+ * Spread the games over a work-stealing pool and wait for all of them
+ */
+void SelfPlayFarm::run() {
+    results.assign(settings.games, GameResult());
+    if (settings.bot == FarmBot::Search && settings.searchDepth > 1 && !table) {
+        table.reset(new TranspositionTable());
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        WorkStealingPool pool(settings.threads);
+        totals.assign(pool.getThreadCount(), WorkerTotals());
+
+        for (int i = 0; i < settings.games; i++) {
+            pool.submit([this, i](int worker) {
+                GameResult result = playGame(gameSeed(settings.baseSeed, i), settings, table.get());
+                results[i] = result;
+
+                WorkerTotals& mine = totals[worker];
+                mine.score += result.score;
+                mine.lines += result.lines;
+                mine.pieces += result.pieces;
+                mine.games++;
+            });
+        }
+        pool.wait();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    elapsedSeconds = elapsed.count();
+}
+
+/**
+ * Combine the per-worker totals and report them
+ */
+void SelfPlayFarm::printSummary(std::ostream& out) const {
+    WorkerTotals sum;
+    for (const auto& worker : totals) {
+        sum.score += worker.score;
+        sum.lines += worker.lines;
+        sum.pieces += worker.pieces;
+        sum.games += worker.games;
+    }
+
+    int bestLevel = 0;
+    double depthSum = 0;
+    for (const auto& result : results) {
+        if (result.level > bestLevel) bestLevel = result.level;
+        depthSum += result.averageDepth;
+    }
+
+    double games = sum.games > 0 ? sum.games : 1;
+    double seconds = elapsedSeconds > 0 ? elapsedSeconds : 1e-9;
+
+    out << "Games: " << sum.games << " on " << totals.size() << " threads in " << elapsedSeconds << "s" << std::endl;
+    out << "Average score: " << sum.score / games
+        << ", lines: " << sum.lines / games
+        << ", pieces: " << sum.pieces / games
+        << ", best level: " << bestLevel << std::endl;
+    out << "Throughput: " << sum.games / seconds << " games/sec, "
+        << sum.pieces / seconds << " pieces/sec" << std::endl;
+
+    if (settings.bot == FarmBot::Search) {
+        out << "Search: depth limit " << settings.searchDepth
+            << ", average depth completed " << depthSum / games << std::endl;
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "TetrisEngine.h"
+#include "TranspositionTable.h"
+#include <vector>
+#include <memory>
+#include <iosfwd>
+#include <cstdint>
+
+/**
+ * @brief Which bot plays the farm's games
+ */
+enum class FarmBot {
+    Random,     ///< Random rotation and column for every piece
+    Search      ///< TetrisAI placement search with default heuristic weights
+};
+
+/**
+ * @brief Settings for a batch of headless self-play games
+ */
+struct FarmSettings {
+    int games = 1000;                           ///< Number of games to play
+    int threads = 0;                            ///< Worker threads (0 = one per hardware thread)
+    uint32_t baseSeed = 1;                      ///< Per-game seeds are derived from this
+    int maxPieces = 10000;                      ///< Stop a game after this many pieces even if still alive
+    FarmBot bot = FarmBot::Random;              ///< Bot playing the games
+    int searchDepth = 1;                        ///< Pieces the search bot looks ahead (1 = current piece only)
+    int moveTimeUs = 0;                         ///< Search bot time budget per move (0 = no limit)
+};
+
+/**
+ * @brief Outcome of one self-play game
+ */
+struct GameResult {
+    uint32_t seed;                              ///< Engine seed the game was played with
+    int score;                                  ///< Final score
+    int lines;                                  ///< Lines cleared
+    int level;                                  ///< Final level
+    int pieces;                                 ///< Pieces placed
+    double durationMs;                          ///< Wall-clock time spent simulating the game
+    double averageDepth;                        ///< Search depth completed per move (search bot only)
+};
+
+/**
+ * @brief Runs many headless games in parallel and aggregates their results
+ *
+ * Each game gets its own TetrisEngine and a seed derived deterministically
+ * from the base seed and the game index, so a batch is reproducible no
+ * matter how the games are spread over threads. Games are scheduled on a
+ * WorkStealingPool; every game writes only its own result slot and every
+ * worker keeps its own running totals, so aggregation needs no shared lock.
+ * Search bots looking ahead share one lock-free TranspositionTable.
+ */
+class SelfPlayFarm {
+public:
+    explicit SelfPlayFarm(const FarmSettings& settings);
+
+    /**
+     * @brief Play every game and block until they are all finished
+     */
+    void run();
+
+    /**
+     * @brief Print totals, averages and throughput (games/sec, pieces/sec)
+     */
+    void printSummary(std::ostream& out) const;
+
+    const std::vector<GameResult>& getResults() const { return results; }
+
+    /**
+     * @brief Seed used for a given game of a batch
+     */
+    static uint32_t gameSeed(uint32_t baseSeed, int gameIndex);
+
+    /**
+     * @brief Play a single game to completion on the calling thread
+     *
+     * @param seed Engine seed
+     * @param settings Bot and limits
+     * @param table Transposition table for search lookahead (null = the bot allocates its own)
+     */
+    static GameResult playGame(uint32_t seed, const FarmSettings& settings, TranspositionTable* table = nullptr);
+
+private:
+    /**
+     * @brief Running totals of one worker, padded to its own cache line
+     */
+    struct alignas(64) WorkerTotals {
+        long long score = 0;
+        long long lines = 0;
+        long long pieces = 0;
+        int games = 0;
+    };
+
+    FarmSettings settings;                      ///< Batch settings
+    std::vector<GameResult> results;            ///< One slot per game, written by the task that played it
+    std::vector<WorkerTotals> totals;           ///< One entry per worker thread
+    std::unique_ptr<TranspositionTable> table;  ///< Shared by every search bot when looking ahead
+    double elapsedSeconds;                      ///< Wall-clock time of the last run
+};
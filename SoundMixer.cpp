@@ -0,0 +1,359 @@
+#include "SoundMixer.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TETRIS_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define TETRIS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    const int MAX_WIDTH = 8;                    // Widest vector, in samples
+
+    /**
+     * acc[i] += src[i] over whole vectors; both must be readable and acc
+     * writable up to count rounded up to the width
+     */
+    template <typename Ops>
+    void accumulate(float* acc, const float* src, size_t count) {
+        for (size_t i = 0; i < count; i += Ops::WIDTH) {
+            Ops::store(acc + i, Ops::add(Ops::load(acc + i), Ops::load(src + i)));
+        }
+    }
+
+    /**
+     * Round to 16-bit with saturation; whole vectors first, then the leftover samples one by one
+     */
+    template <typename Ops>
+    void convert(const float* acc, int16_t* out, size_t count) {
+        size_t i = 0;
+        for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {
+            Ops::storeSamples(out + i, Ops::load(acc + i));
+        }
+        for (; i < count; i++) {
+            float clamped = std::max(-32768.0f, std::min(acc[i], 32767.0f));
+            out[i] = static_cast<int16_t>(std::lrint(clamped));
+        }
+    }
+
+    /**
+     * Reference path: one float at a time
+     */
+    struct ScalarOps {
+        using Vec = float;
+        static const int WIDTH = 1;
+
+        static Vec load(const float* p) { return *p; }
+        static void store(float* p, Vec v) { *p = v; }
+        static Vec add(Vec a, Vec b) { return a + b; }
+        static void storeSamples(int16_t* p, Vec v) {
+            *p = static_cast<int16_t>(std::lrint(std::max(-32768.0f, std::min(v, 32767.0f))));
+        }
+    };
+
+#ifdef TETRIS_HAVE_SSE2
+    /**
+     * 4 x float lanes in SSE2 registers (voices start anywhere, so loads are unaligned)
+     */
+    struct Sse2Ops {
+        using Vec = __m128;
+        static const int WIDTH = 4;
+
+        static Vec load(const float* p) { return _mm_loadu_ps(p); }
+        static void store(float* p, Vec v) { _mm_storeu_ps(p, v); }
+        static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+        static void storeSamples(int16_t* p, Vec v) {
+            __m128i words = _mm_cvtps_epi32(v);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(words, words));
+        }
+    };
+#endif
+
+#ifdef TETRIS_HAVE_AVX2
+    /**
+     * 8 x float lanes in AVX2 registers
+     */
+    struct Avx2Ops {
+        using Vec = __m256;
+        static const int WIDTH = 8;
+
+        static Vec load(const float* p) { return _mm256_loadu_ps(p); }
+        static void store(float* p, Vec v) { _mm256_storeu_ps(p, v); }
+        static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+        static void storeSamples(int16_t* p, Vec v) {
+            // Pack the two 128-bit halves so the samples stay in order
+            __m256i words = _mm256_cvtps_epi32(v);
+            __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packed);
+        }
+    };
+#endif
+}
+
+const int SoundMixer::MAX_BLOCK_FRAMES;
+
+/**
+ * Constructor - Allocate the accumulator now; no effect has voices yet
+ */
+SoundMixer::SoundMixer(int activeLimit, MixBackend backend) :
+    backend(isAvailable(backend) ? backend : bestBackend()),
+    activeLimit(activeLimit),
+    voicesUsed(0),
+    commands(),
+    commandHead(0),
+    commandTail(0),
+    effects(),
+    playCounter(0),
+    accumulator(MAX_BLOCK_FRAMES),
+    activeCount(0)
+{
+    for (Voice& voice : voices) {
+        voice.effect = NO_EFFECT;
+        voice.position = 0;
+        voice.startedAt = 0;
+    }
+}
+
+/**
+ * Convert the samples to mono at the mixer rate and hand out the next block of voices
+ */
+bool SoundMixer::setEffect(SoundEffect effect, const int16_t* samples, size_t sampleCount,
+                           unsigned channelCount, unsigned sampleRate, const VoiceSettings& settings) {
+    EffectVoices& block = effects[static_cast<int>(effect)];
+
+    // Average the channels
+    size_t frames = channelCount > 0 ? sampleCount / channelCount : 0;
+    std::vector<float> mono(frames);
+    for (size_t i = 0; i < frames; i++) {
+        float sum = 0;
+        for (unsigned c = 0; c < channelCount; c++) {
+            sum += samples[i * channelCount + c];
+        }
+        mono[i] = sum / channelCount;
+    }
+
+    // Linear interpolation to the mixer rate, padded so the last vector reads zeros
+    size_t length = frames;
+    if (sampleRate != SAMPLE_RATE && sampleRate > 0 && frames > 0) {
+        length = static_cast<size_t>(static_cast<double>(frames) * SAMPLE_RATE / sampleRate);
+    }
+    block.samples.assign(length + MAX_WIDTH, 0.0f);
+    block.length = length;
+    double step = length > 0 ? static_cast<double>(frames) / length : 0;
+    for (size_t i = 0; i < length; i++) {
+        double source = i * step;
+        size_t index = static_cast<size_t>(source);
+        size_t next = std::min(index + 1, frames - 1);
+        float fraction = static_cast<float>(source - index);
+        block.samples[i] = mono[index] + (mono[next] - mono[index]) * fraction;
+    }
+
+    int count = std::min(settings.polyphony, MAX_VOICES - voicesUsed);
+    block.first = voicesUsed;
+    block.count = count;
+    block.priority = settings.priority;
+    for (int i = block.first; i < block.first + count; i++) {
+        voices[i].effect = static_cast<int>(effect);
+        voices[i].position = length;
+    }
+    voicesUsed += count;
+    return count == settings.polyphony;
+}
+
+bool SoundMixer::play(SoundEffect effect) {
+    Command command;
+    command.type = Command::Play;
+    command.effect = static_cast<uint8_t>(effect);
+    return push(command);
+}
+
+bool SoundMixer::stopAll() {
+    Command command;
+    command.type = Command::StopAll;
+    command.effect = 0;
+    return push(command);
+}
+
+/**
+ * Single producer: write the slot, then publish it by advancing the tail
+ */
+bool SoundMixer::push(Command command) {
+    unsigned tail = commandTail.load(std::memory_order_relaxed);
+    if (tail - commandHead.load(std::memory_order_acquire) >= COMMAND_CAPACITY) return false;
+
+    commands[tail % COMMAND_CAPACITY] = command;
+    commandTail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ * Single consumer: apply everything published so far, then free the slots
+ */
+void SoundMixer::applyCommands() {
+    unsigned head = commandHead.load(std::memory_order_relaxed);
+    unsigned tail = commandTail.load(std::memory_order_acquire);
+    for (; head != tail; head++) {
+        const Command& command = commands[head % COMMAND_CAPACITY];
+        if (command.type == Command::Play) {
+            startVoice(command.effect);
+        }
+        else {
+            for (Voice& voice : voices) {
+                if (voice.effect != NO_EFFECT) voice.position = effects[voice.effect].length;
+            }
+        }
+    }
+    commandHead.store(head, std::memory_order_release);
+}
+
+/**
+ * Pick a voice from the effect's block, make room under the active limit, start it
+ */
+void SoundMixer::startVoice(int effect) {
+    if (effect >= AssetLoader::SOUND_COUNT) return;
+    const EffectVoices& block = effects[effect];
+    if (block.count == 0) return;
+
+    // A silent voice of this effect, else its oldest one
+    Voice* chosen = nullptr;
+    for (int i = block.first; i < block.first + block.count; i++) {
+        Voice& voice = voices[i];
+        if (!isPlaying(voice)) {
+            chosen = &voice;
+            break;
+        }
+        if (!chosen || voice.startedAt < chosen->startedAt) {
+            chosen = &voice;
+        }
+    }
+
+    // Starting a silent voice adds one to the active count; steal one if that goes over the limit
+    if (!isPlaying(*chosen)) {
+        int active = 0;
+        Voice* victim = nullptr;
+        for (Voice& voice : voices) {
+            if (voice.effect == NO_EFFECT || !isPlaying(voice)) continue;
+            active++;
+
+            int priority = effects[voice.effect].priority;
+            if (priority > block.priority) continue;
+
+            if (!victim) {
+                victim = &voice;
+                continue;
+            }
+            int victimPriority = effects[victim->effect].priority;
+            if (priority < victimPriority || (priority == victimPriority && voice.startedAt < victim->startedAt)) {
+                victim = &voice;
+            }
+        }
+
+        if (active >= activeLimit) {
+            if (!victim) return;
+            victim->position = effects[victim->effect].length;
+        }
+    }
+
+    chosen->position = 0;  // Restarts it from the beginning if it was still playing
+    chosen->startedAt = ++playCounter;
+}
+
+bool SoundMixer::isPlaying(const Voice& voice) const {
+    return voice.position < effects[voice.effect].length;
+}
+
+/**
+ * Sum the playing voices into the accumulator, then round it to 16-bit
+ */
+void SoundMixer::mix(int16_t* out, int frames) {
+    applyCommands();
+
+    size_t count = static_cast<size_t>(std::max(0, std::min(frames, MAX_BLOCK_FRAMES)));
+    std::fill(accumulator.begin(), accumulator.begin() + count, 0.0f);
+
+    int active = 0;
+    for (Voice& voice : voices) {
+        if (voice.effect == NO_EFFECT || !isPlaying(voice)) continue;
+
+        const EffectVoices& block = effects[voice.effect];
+        size_t span = std::min(count, block.length - voice.position);
+        const float* src = block.samples.data() + voice.position;
+        switch (backend) {
+#ifdef TETRIS_HAVE_AVX2
+        case MixBackend::AVX2:
+            accumulate<Avx2Ops>(accumulator.data(), src, span);
+            break;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+        case MixBackend::SSE2:
+            accumulate<Sse2Ops>(accumulator.data(), src, span);
+            break;
+#endif
+        default:
+            accumulate<ScalarOps>(accumulator.data(), src, span);
+            break;
+        }
+
+        voice.position += span;
+        if (isPlaying(voice)) active++;
+    }
+
+    switch (backend) {
+#ifdef TETRIS_HAVE_AVX2
+    case MixBackend::AVX2:
+        convert<Avx2Ops>(accumulator.data(), out, count);
+        break;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+    case MixBackend::SSE2:
+        convert<Sse2Ops>(accumulator.data(), out, count);
+        break;
+#endif
+    default:
+        convert<ScalarOps>(accumulator.data(), out, count);
+        break;
+    }
+
+    activeCount.store(active, std::memory_order_relaxed);
+}
+
+/**
+ * Report whether a backend was compiled in
+ */
+bool SoundMixer::isAvailable(MixBackend backend) {
+    switch (backend) {
+#ifdef TETRIS_HAVE_AVX2
+    case MixBackend::AVX2: return true;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+    case MixBackend::SSE2: return true;
+#endif
+    case MixBackend::Scalar: return true;
+    default: return false;
+    }
+}
+
+/**
+ * Pick the widest backend compiled in
+ */
+MixBackend SoundMixer::bestBackend() {
+    if (isAvailable(MixBackend::AVX2)) return MixBackend::AVX2;
+    if (isAvailable(MixBackend::SSE2)) return MixBackend::SSE2;
+    return MixBackend::Scalar;
+}
+
+/**
+ * Backend display names
+ */
+const char* SoundMixer::backendName(MixBackend backend) {
+    switch (backend) {
+    case MixBackend::SSE2: return "SSE2";
+    case MixBackend::AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#include "AssetLoader.h"
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief How an effect shares the mixer's voices
+ */
+struct VoiceSettings {
+    int polyphony;                              ///< Instances of the effect that can sound at once
+    int priority;                               ///< Higher priorities may cut off lower ones when the mixer is busy
+};
+
+/**
+ * @brief Instruction sets the mixer can accumulate samples with
+ */
+enum class MixBackend {
+    Scalar,     ///< One sample at a time, portable
+    SSE2,       ///< 4 samples per 128-bit register
+    AVX2        ///< 8 samples per 256-bit register (needs /arch:AVX2 or -mavx2)
+};
+
+/**
+ * @brief In-process mixer for the sound effects
+ *
+ * Every effect voice is summed into one block of samples that a single
+ * output plays: MixerStream for the sound card, WavOutput for a file. So
+ * the game needs one OpenAL source for all its effects instead of one per
+ * voice, and effect latency is set by the output's buffer size instead of
+ * OpenAL's internal buffering.
+ *
+ * The game thread submits play and stop commands through a fixed-size
+ * single-producer, single-consumer queue; the output thread applies them at
+ * the start of each mix() call, so neither side ever waits for the other.
+ * Voice allocation follows the same rules on the output thread: each effect
+ * owns a block of `polyphony` voices and restarts its oldest one when all
+ * are busy, and at most activeLimit voices sound at once, a new sound
+ * stealing the lowest-priority, oldest voice whose priority is not above
+ * its own or else being dropped.
+ *
+ * Effects are converted to mono float at SAMPLE_RATE once in setEffect();
+ * mix() then only adds samples, several per instruction on the SIMD
+ * backends, and never allocates.
+ */
+class SoundMixer {
+public:
+    static const unsigned SAMPLE_RATE = 44100;  ///< Output sample rate (mono)
+    static const int MAX_VOICES = 16;           ///< Voices available to the effects
+    static const int DEFAULT_ACTIVE_LIMIT = 10; ///< Default number of voices allowed to sound at once
+    static const int MAX_BLOCK_FRAMES = 4096;   ///< Most samples one mix() call produces
+    static const int COMMAND_CAPACITY = 64;     ///< Commands that can wait for the next mix() call
+
+    /**
+     * @brief Constructor
+     *
+     * @param activeLimit Voices allowed to sound at once
+     * @param backend Backend to use; falls back to the best available one if not compiled in
+     */
+    explicit SoundMixer(int activeLimit = DEFAULT_ACTIVE_LIMIT, MixBackend backend = bestBackend());
+
+    SoundMixer(const SoundMixer&) = delete;
+    SoundMixer& operator=(const SoundMixer&) = delete;
+
+    /**
+     * @brief Give an effect its voices and samples
+     *
+     * Call once per effect before an output starts pulling from the mixer.
+     * Any channel count and sample rate is accepted; the samples are copied
+     * and converted to mono at SAMPLE_RATE.
+     *
+     * @param samples Interleaved 16-bit samples
+     * @param sampleCount Number of samples (all channels)
+     * @return false if fewer free voices were left than the polyphony asked for
+     * (the effect then gets the voices that are left, if any)
+     */
+    bool setEffect(SoundEffect effect, const int16_t* samples, size_t sampleCount,
+                   unsigned channelCount, unsigned sampleRate, const VoiceSettings& settings);
+
+    /**
+     * @brief Start an instance of an effect at the next mix (producer thread)
+     *
+     * @return false if the command queue is full and the sound was dropped
+     */
+    bool play(SoundEffect effect);
+
+    /**
+     * @brief Silence every voice at the next mix (producer thread)
+     *
+     * @return false if the command queue is full
+     */
+    bool stopAll();
+
+    /**
+     * @brief Apply the pending commands and produce the next block (output thread)
+     *
+     * @param out Receives `frames` mono 16-bit samples
+     * @param frames Samples to produce, at most MAX_BLOCK_FRAMES
+     */
+    void mix(int16_t* out, int frames);
+
+    /**
+     * @brief Number of voices that were sounding at the end of the latest mix (any thread)
+     */
+    int getActiveCount() const { return activeCount.load(std::memory_order_relaxed); }
+
+    MixBackend getBackend() const { return backend; }
+
+    /**
+     * @brief Whether a backend was compiled into this build
+     */
+    static bool isAvailable(MixBackend backend);
+
+    /**
+     * @brief Widest backend compiled into this build
+     */
+    static MixBackend bestBackend();
+
+    /**
+     * @brief Display name of a backend
+     */
+    static const char* backendName(MixBackend backend);
+
+private:
+    static const int NO_EFFECT = -1;
+
+    /**
+     * @brief A queued request from the producer thread
+     */
+    struct Command {
+        enum Type : uint8_t { Play, StopAll } type;
+        uint8_t effect;                         ///< SoundEffect to play
+    };
+
+    /**
+     * @brief Playback state of one voice
+     */
+    struct Voice {
+        int effect;                             ///< SoundEffect it belongs to (NO_EFFECT = unused)
+        size_t position;                        ///< Next sample to mix (>= the effect's length = silent)
+        uint64_t startedAt;                     ///< Play counter value when it last started
+    };
+
+    /**
+     * @brief An effect's samples and block of voices
+     */
+    struct EffectVoices {
+        std::vector<float> samples;             ///< Mono samples at SAMPLE_RATE, zero-padded for whole vectors
+        size_t length;                          ///< Samples before the padding
+        int first;                              ///< Index of its first voice
+        int count;                              ///< Voices in the block (0 = effect not set)
+        int priority;                           ///< VoiceSettings::priority
+    };
+
+    MixBackend backend;                         ///< Backend mix() dispatches to
+    int activeLimit;                            ///< Voices allowed to sound at once
+    int voicesUsed;                             ///< Voices handed out by setEffect
+
+    // Producer -> output command queue (indices only ever increase; slot = index % capacity)
+    Command commands[COMMAND_CAPACITY];         ///< Ring of pending commands
+    std::atomic<unsigned> commandHead;          ///< Next command to apply (written by the output thread)
+    std::atomic<unsigned> commandTail;          ///< Next free slot (written by the producer thread)
+
+    // ---- Owned by the output thread once it is running ----
+    Voice voices[MAX_VOICES];                   ///< The voices
+    EffectVoices effects[AssetLoader::SOUND_COUNT];  ///< Per SoundEffect
+    uint64_t playCounter;                       ///< Increments on every play, ages the voices
+    std::vector<float> accumulator;             ///< Sum of the voices for the current block
+    std::atomic<int> activeCount;               ///< Voices sounding after the latest mix
+
+    bool push(Command command);
+    void applyCommands();
+    void startVoice(int effect);
+    bool isPlaying(const Voice& voice) const;
+};
@@ -1,71 +1,97 @@
 #include "Tetris.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <cstdio>
+#include <thread>
+
+namespace {
+    /**
+     * @brief Keyboard key that drives an input controller button
+     */
+    struct KeyBinding {
+        sf::Keyboard::Key code;
+        InputKey key;
+    };
+
+    const KeyBinding KEY_BINDINGS[InputController::KEY_COUNT] = {
+        { sf::Keyboard::Left,  InputKey::Left },     // Move piece left, repeating after DAS
+        { sf::Keyboard::Right, InputKey::Right },    // Move piece right, repeating after DAS
+        { sf::Keyboard::Down,  InputKey::SoftDrop }, // Soft drop for small score bonus
+        { sf::Keyboard::Up,    InputKey::Rotate },   // Rotate piece clockwise if possible
+        { sf::Keyboard::Space, InputKey::HardDrop }, // Hard drop - instantly drop piece to bottom
+        { sf::Keyboard::R,     InputKey::Restart }   // Restart game (only accepted after game over)
+    };
+}
 
 /**
  * Constructor - Initialize the game with default values and setup
  */
-Tetris::Tetris() :
-    board(BOARD_HEIGHT, std::vector<int>(BOARD_WIDTH, 0)),  // Initialize empty board
+Tetris::Tetris(const GameOptions& options) :
+    running(false),
+    windowFocused(true),
+    pendingRequests(0),
+    showProfiler(false),
+    redrawRequested(false),
+    opponentConnected(options.versus != nullptr),
+    engine(options.playback ? options.playback->getSeed() : options.seed),
+    recording(engine.getSeed()),
+    recordPath(options.recordPath),
+    versusPeer(options.versus),
+    opponent(engine.getSeed()),
+    versusKeys(0),
+    desyncReported(false),
+    demoMode(options.demo && !options.playback),
+    demoCounter(0),
+    lastUpdateTime(0),
+    lastTickTime(0),
+    tickAccumulator(0),
+    snapshotDirty(true),
+    input(options.input),
+    keysHeld(),
+    smoothFall(options.smoothFall),
+    pacer(options.pacing),
+    profiler(!options.profilePath.empty()),
+    profilePath(options.profilePath),
+    profilerShown(false),
+    profilerRefreshCounter(0),
+    assets(options.assetPack),
     window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Tetris"),
-    rng(std::chrono::steady_clock::now().time_since_epoch().count()),  // Seed RNG with current time
-    pieceDist(0, 6),  // Distribution for 7 different piece types (0-6)
-    score(0),
-    level(1),
-    linesCleared(0),
-    gameOver(false),
-    dropTimer(0),
-    dropInterval(500.0f),  // Initial drop interval of 500ms
+    boardRenderer(BLOCK_SIZE),
+    opponentRenderer(OPPONENT_BLOCK_SIZE),
+    controlsBaked(false),
+    shownScore(-1),
+    shownLevel(-1),
+    shownSoundEnabled(false),
+    shownOpponentConnected(false),
+    mixer(),
+    mixerOutput(mixer, options.mixerBufferFrames),
+    soundsAttached(false),
+    music(),
+    musicEnabled(options.music),
     soundEnabled(true)     // Enable sound by default
 {
-    // Set frame rate limit for smooth gameplay
-    window.setFramerateLimit(60);
-
-    // Initialize all Tetris piece shapes
-    // Each piece is defined in a 4x4 grid with numbers representing colors
-    pieces = {
-        // I-piece (cyan) - straight line piece
-        {{0,0,0,0},
-         {1,1,1,1},
-         {0,0,0,0},
-         {0,0,0,0}},
-
-         // O-piece (yellow) - square piece
-         {{0,0,0,0},
-          {0,2,2,0},
-          {0,2,2,0},
-          {0,0,0,0}},
-
-          // T-piece (purple) - T-shaped piece
-          {{0,0,0,0},
-           {0,3,0,0},
-           {3,3,3,0},
-           {0,0,0,0}},
-
-           // S-piece (green) - S-shaped piece
-           {{0,0,0,0},
-            {0,4,4,0},
-            {4,4,0,0},
-            {0,0,0,0}},
-
-            // Z-piece (red) - Z-shaped piece
-            {{0,0,0,0},
-             {5,5,0,0},
-             {0,5,5,0},
-             {0,0,0,0}},
-
-             // J-piece (blue) - J-shaped piece
-             {{0,0,0,0},
-              {6,0,0,0},
-              {6,6,6,0},
-              {0,0,0,0}},
-
-              // L-piece (orange) - L-shaped piece
-              {{0,0,0,0},
-               {0,0,7,0},
-               {7,7,7,0},
-               {0,0,0,0}}
-    };
+    // Vsync or our own limiter, depending on the pacing mode
+    pacer.configure(window);
+
+    // Held keys are sampled and auto-repeated per tick by the simulation thread, not by the OS
+    window.setKeyRepeatEnabled(false);
+
+    if (options.playback) {
+        replayPlayer.reset(new ReplayPlayer(*options.playback));
+        std::cout << "Playing back replay (seed " << engine.getSeed() << ", "
+                  << options.playback->getLength() << " ticks)" << std::endl;
+    }
+
+    // The host is player 0 on both sides, so both peers build the same match
+    if (versusPeer) {
+        TetrisEngine& first = versusPeer->getLocalPlayer() == 0 ? engine : opponent;
+        TetrisEngine& second = versusPeer->getLocalPlayer() == 0 ? opponent : engine;
+        match.reset(new VersusMatch(first, second, engine.getSeed(),
+                                    versusPeer->getPlayerSettings(0), versusPeer->getPlayerSettings(1)));
+        std::cout << "Versus match as player " << versusPeer->getLocalPlayer() + 1 << " (input delay "
+                  << versusPeer->getInputDelay() << " ticks)" << std::endl;
+    }
 
     // Color mapping for each piece type (index 0 is empty/black)
     colors = {
@@ -76,209 +102,111 @@ Tetris::Tetris() :
         sf::Color::Green,        // 4 - S piece
         sf::Color::Red,          // 5 - Z piece
         sf::Color::Blue,         // 6 - J piece
-        sf::Color(255,165,0)     // 7 - L piece (orange)
+        sf::Color(255,165,0),    // 7 - L piece (orange)
+        sf::Color(110,110,110)   // 8 - garbage rows from a versus opponent (gray)
     };
 
-    // Try to load font from multiple possible locations
-    bool fontLoaded = false;
-    std::vector<std::string> fontPaths = {
-        "arial.ttf",                    // Current directory
-        "fonts/arial.ttf",              // fonts subdirectory
-        "assets/fonts/arial.ttf",       // assets/fonts subdirectory
-        "/System/Library/Fonts/Arial.ttf",           // macOS system font
-        "/Windows/Fonts/arial.ttf",                  // Windows system font
-        "/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf",  // Linux common font
-        "/usr/share/fonts/TTF/arial.ttf"            // Linux alternative
-    };
-
-    for (const auto& path : fontPaths) {
-        if (font.loadFromFile(path)) {
-            std::cout << "Successfully loaded font: " << path << std::endl;
-            fontLoaded = true;
-            break;
-        }
+    // The loader started on the font and sounds before the window was created;
+    // only the font is needed to lay out the first frame, the sounds attach later
+    if (assets.waitForFont()) {
+        std::cout << "Successfully loaded font: " << assets.getFontPath() << std::endl;
     }
-
-    if (!fontLoaded) {
+    else {
         std::cout << "Warning: Could not load any font file. Text may not display correctly." << std::endl;
         std::cout << "To fix this, place arial.ttf in the game directory or fonts/ subdirectory." << std::endl;
     }
 
-    // Initialize audio system
-    loadSounds();
-
-    // Initialize UI elements and spawn first piece
+    // Initialize UI elements
     setupText();
-    spawnNewPiece();
+
+    // Give the render thread a first frame to draw (the engine has already spawned the first piece)
+    publishSnapshot();
 }
 
 /**
- * Load all sound effect files
+ * Copy each effect's loaded samples into the mixer, then start mixing
  */
-void Tetris::loadSounds() {
-    // Try to load sound files from multiple locations
-    std::vector<std::string> soundPaths = {
-        "",                     // Current directory
-        "sounds/",              // sounds subdirectory
-        "assets/sounds/",       // assets/sounds subdirectory
-        "audio/"                // audio subdirectory
+void Tetris::attachSounds() {
+    struct SoundSlot {
+        SoundEffect effect;
+        VoiceSettings settings;
+        const char* name;
     };
 
-    std::vector<std::string> soundFiles = {
-        "move.wav", "rotate.wav", "drop.wav", "line_clear.wav", "game_over.wav", "level_up.wav"
+    // Quick, frequent effects get the most voices; rare, important ones win when the mixer is busy
+    const SoundSlot slots[AssetLoader::SOUND_COUNT] = {
+        { SoundEffect::Move,      { 4, 0 }, "move" },
+        { SoundEffect::Rotate,    { 3, 0 }, "rotate" },
+        { SoundEffect::Drop,      { 3, 1 }, "drop" },
+        { SoundEffect::LineClear, { 2, 2 }, "line clear" },
+        { SoundEffect::GameOver,  { 1, 3 }, "game over" },
+        { SoundEffect::LevelUp,   { 1, 2 }, "level up" }
     };
 
-    bool anyLoaded = false;
-
-    // Try to load each sound file
-    for (const auto& basePath : soundPaths) {
-        if (moveBuffer.loadFromFile(basePath + "move.wav")) {
-            moveSound.setBuffer(moveBuffer);
-            anyLoaded = true;
-            std::cout << "Loaded move sound from: " << basePath << "move.wav" << std::endl;
-            break;
-        }
-    }
-
-    for (const auto& basePath : soundPaths) {
-        if (rotateBuffer.loadFromFile(basePath + "rotate.wav")) {
-            rotateSound.setBuffer(rotateBuffer);
-            anyLoaded = true;
-            std::cout << "Loaded rotate sound from: " << basePath << "rotate.wav" << std::endl;
-            break;
-        }
-    }
-
-    for (const auto& basePath : soundPaths) {
-        if (dropBuffer.loadFromFile(basePath + "drop.wav")) {
-            dropSound.setBuffer(dropBuffer);
-            anyLoaded = true;
-            std::cout << "Loaded drop sound from: " << basePath << "drop.wav" << std::endl;
-            break;
+    for (const SoundSlot& slot : slots) {
+        const sf::SoundBuffer& buffer = assets.getSoundBuffer(slot.effect);
+        mixer.setEffect(slot.effect, buffer.getSamples(), static_cast<size_t>(buffer.getSampleCount()),
+                        buffer.getChannelCount(), buffer.getSampleRate(), slot.settings);
+        const std::string& path = assets.getSoundPath(slot.effect);
+        if (!path.empty()) {
+            std::cout << "Loaded " << slot.name << " sound from: " << path << std::endl;
         }
     }
 
-    for (const auto& basePath : soundPaths) {
-        if (lineClearBuffer.loadFromFile(basePath + "line_clear.wav")) {
-            lineClearSound.setBuffer(lineClearBuffer);
-            anyLoaded = true;
-            std::cout << "Loaded line clear sound from: " << basePath << "line_clear.wav" << std::endl;
-            break;
-        }
+    if (assets.soundsGenerated()) {
+        std::cout << "No sound files found. Generated simple sound effects." << std::endl;
     }
 
-    for (const auto& basePath : soundPaths) {
-        if (gameOverBuffer.loadFromFile(basePath + "game_over.wav")) {
-            gameOverSound.setBuffer(gameOverBuffer);
-            anyLoaded = true;
-            std::cout << "Loaded game over sound from: " << basePath << "game_over.wav" << std::endl;
-            break;
-        }
-    }
+    // The effects are in place before the streaming thread first pulls from the mixer,
+    // and nothing queued before now is left to play all at once
+    mixer.stopAll();
+    mixerOutput.play();
+    soundsAttached = true;
+}
 
-    for (const auto& basePath : soundPaths) {
-        if (levelUpBuffer.loadFromFile(basePath + "level_up.wav")) {
-            levelUpSound.setBuffer(levelUpBuffer);
-            anyLoaded = true;
-            std::cout << "Loaded level up sound from: " << basePath << "level_up.wav" << std::endl;
-            break;
-        }
+/**
+ * Play a sound effect if audio is enabled; until the sounds are attached nothing
+ * drains the mixer's queue, so plays are dropped instead of bursting out later
+ */
+void Tetris::playSound(SoundEffect effect) {
+    if (soundEnabled && soundsAttached) {
+        mixer.play(effect);
     }
+}
 
-    if (!anyLoaded) {
-        std::cout << "No sound files found. Generating simple sound effects..." << std::endl;
-        generateSounds();
+/**
+ * Schedule a sound effect if audio is enabled and the sounds are attached
+ */
+void Tetris::playSoundAfter(SoundEffect effect, sf::Time delay) {
+    if (soundEnabled && soundsAttached) {
+        audioCues.schedule(effect, delay);
     }
 }
 
 /**
- * Generate simple sound effects programmatically
+ * Music follows the sound toggle; pausing keeps its place in the progression
  */
-void Tetris::generateSounds() {
-    const unsigned SAMPLE_RATE = 44100;
-    const unsigned SAMPLES = SAMPLE_RATE / 4; // 0.25 second sounds
-
-    // Generate move sound (short beep)
-    std::vector<sf::Int16> moveSamples(SAMPLES);
-    for (unsigned i = 0; i < SAMPLES; i++) {
-        float time = static_cast<float>(i) / SAMPLE_RATE;
-        float amplitude = 3000.0f * std::exp(-time * 10.0f); // Decaying amplitude
-        moveSamples[i] = static_cast<sf::Int16>(amplitude * std::sin(2 * 3.1415 * 800 * time));
-    }
-    moveBuffer.loadFromSamples(moveSamples.data(), moveSamples.size(), 1, SAMPLE_RATE);
-    moveSound.setBuffer(moveBuffer);
-
-    // Generate rotate sound (higher pitch beep)
-    std::vector<sf::Int16> rotateSamples(SAMPLES);
-    for (unsigned i = 0; i < SAMPLES; i++) {
-        float time = static_cast<float>(i) / SAMPLE_RATE;
-        float amplitude = 3000.0f * std::exp(-time * 8.0f);
-        rotateSamples[i] = static_cast<sf::Int16>(amplitude * std::sin(2 * 3.1415 * 1200 * time));
-    }
-    rotateBuffer.loadFromSamples(rotateSamples.data(), rotateSamples.size(), 1, SAMPLE_RATE);
-    rotateSound.setBuffer(rotateBuffer);
-
-    // Generate drop sound (lower thud)
-    std::vector<sf::Int16> dropSamples(SAMPLES);
-    for (unsigned i = 0; i < SAMPLES; i++) {
-        float time = static_cast<float>(i) / SAMPLE_RATE;
-        float amplitude = 5000.0f * std::exp(-time * 15.0f);
-        dropSamples[i] = static_cast<sf::Int16>(amplitude * std::sin(2 * 3.1415 * 200 * time));
-    }
-    dropBuffer.loadFromSamples(dropSamples.data(), dropSamples.size(), 1, SAMPLE_RATE);
-    dropSound.setBuffer(dropBuffer);
-
-    // Generate line clear sound (pleasant chime)
-    const unsigned LINE_SAMPLES = SAMPLE_RATE / 2; // 0.5 second
-    std::vector<sf::Int16> lineSamples(LINE_SAMPLES);
-    for (unsigned i = 0; i < LINE_SAMPLES; i++) {
-        float time = static_cast<float>(i) / SAMPLE_RATE;
-        float amplitude = 4000.0f * std::exp(-time * 3.0f);
-        float freq1 = 523.25f; // C5
-        float freq2 = 659.25f; // E5
-        float freq3 = 783.99f; // G5
-        lineSamples[i] = static_cast<sf::Int16>(amplitude * (
-            std::sin(2 * 3.1415 * freq1 * time) +
-            std::sin(2 * 3.1415 * freq2 * time) +
-            std::sin(2 * 3.1415 * freq3 * time)
-            ) / 3.0f);
-    }
-    lineClearBuffer.loadFromSamples(lineSamples.data(), lineSamples.size(), 1, SAMPLE_RATE);
-    lineClearSound.setBuffer(lineClearBuffer);
-
-    // Generate game over sound (descending tones)
-    const unsigned GAME_OVER_SAMPLES = SAMPLE_RATE; // 1 second
-    std::vector<sf::Int16> gameOverSamples(GAME_OVER_SAMPLES);
-    for (unsigned i = 0; i < GAME_OVER_SAMPLES; i++) {
-        float time = static_cast<float>(i) / SAMPLE_RATE;
-        float freq = 440.0f * std::exp(-time * 2.0f); // Descending frequency
-        float amplitude = 4000.0f * std::exp(-time * 2.0f);
-        gameOverSamples[i] = static_cast<sf::Int16>(amplitude * std::sin(2 * 3.1415 * freq * time));
-    }
-    gameOverBuffer.loadFromSamples(gameOverSamples.data(), gameOverSamples.size(), 1, SAMPLE_RATE);
-    gameOverSound.setBuffer(gameOverBuffer);
-
-    // Generate level up sound (ascending chime)
-    std::vector<sf::Int16> levelUpSamples(LINE_SAMPLES);
-    for (unsigned i = 0; i < LINE_SAMPLES; i++) {
-        float time = static_cast<float>(i) / SAMPLE_RATE;
-        float amplitude = 4000.0f * std::exp(-time * 2.0f);
-        float freq = 440.0f + time * 880.0f; // Ascending frequency
-        levelUpSamples[i] = static_cast<sf::Int16>(amplitude * std::sin(2 * 3.1415 * freq * time));
-    }
-    levelUpBuffer.loadFromSamples(levelUpSamples.data(), levelUpSamples.size(), 1, SAMPLE_RATE);
-    levelUpSound.setBuffer(levelUpBuffer);
-
-    std::cout << "Generated synthetic sound effects successfully." << std::endl;
+void Tetris::updateMusicPlayback() {
+    bool wanted = musicEnabled && soundEnabled;
+    bool playing = music.getStatus() == sf::SoundStream::Playing;
+    if (wanted && !playing) {
+        music.play();
+    }
+    else if (!wanted && playing) {
+        music.pause();
+    }
 }
 
 /**
- * Play a sound effect if audio is enabled
+ * Stack height is measured from the topmost non-empty row
  */
-void Tetris::playSound(sf::Sound& sound) {
-    if (soundEnabled) {
-        sound.play();
+void Tetris::updateMusicState() {
+    const uint16_t* rows = engine.getRows();
+    int top = 0;
+    while (top < BOARD_HEIGHT && rows[top] == 0) {
+        top++;
     }
+    music.setGameState(engine.getLevel(), BOARD_HEIGHT - top, engine.isGameOver());
 }
 
 /**
@@ -286,363 +214,671 @@ void Tetris::playSound(sf::Sound& sound) {
  */
 void Tetris::setupText() {
     // Configure score display
-    scoreText.setFont(font);
+    scoreText.setFont(assets.getFont());
     scoreText.setCharacterSize(20);
     scoreText.setFillColor(sf::Color::White);
     scoreText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, 10);  // Position to right of game board
 
     // Configure level display
-    levelText.setFont(font);
+    levelText.setFont(assets.getFont());
     levelText.setCharacterSize(20);
     levelText.setFillColor(sf::Color::White);
     levelText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, 40);  // Below score
 
     // Configure game over message
-    gameOverText.setFont(font);
+    gameOverText.setFont(assets.getFont());
     gameOverText.setCharacterSize(30);
     gameOverText.setFillColor(sf::Color::Red);
     gameOverText.setString("GAME OVER");
     gameOverText.setPosition(50, WINDOW_HEIGHT / 2);  // Center of screen
+
+    // Configure restart instruction
+    restartText.setFont(assets.getFont());
+    restartText.setCharacterSize(20);
+    restartText.setFillColor(sf::Color::White);
+    restartText.setString("Press R to restart");
+    restartText.setPosition(50, WINDOW_HEIGHT / 2 + 40);
+
+    // Configure sound status (string and color are set by updateHud)
+    soundStatusText.setFont(assets.getFont());
+    soundStatusText.setCharacterSize(16);
+    soundStatusText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, 70);
+
+    // Configure controls help
+    controlsText.setFont(assets.getFont());
+    controlsText.setCharacterSize(14);
+    controlsText.setFillColor(sf::Color::White);
+    controlsText.setString("Controls:\nArrows: Move\nUp: Rotate\nSpace: Hard Drop\nM: Toggle Sound\nA: Demo Mode\nF3: Frame Stats");
+    controlsText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, 100);
+
+    // Bake the static controls panel into a texture once so each frame draws a single sprite.
+    // The panel is cleared to the window background color to avoid fringes around glyphs.
+    sf::FloatRect bounds = controlsText.getLocalBounds();
+    controlsBaked = controlsTexture.create(static_cast<unsigned>(bounds.left + bounds.width) + 1,
+                                           static_cast<unsigned>(bounds.top + bounds.height) + 1);
+    if (controlsBaked) {
+        sf::Text bakedText(controlsText);
+        bakedText.setPosition(0, 0);
+        controlsTexture.clear(sf::Color::Black);
+        controlsTexture.draw(bakedText);
+        controlsTexture.display();
+        controlsSprite.setTexture(controlsTexture.getTexture(), true);
+        controlsSprite.setPosition(controlsText.getPosition());
+    }
+
+    // Configure frame stats overlay (below the controls help; string is set by updateProfilerText)
+    profilerText.setFont(assets.getFont());
+    profilerText.setCharacterSize(11);
+    profilerText.setFillColor(sf::Color(160, 160, 160));
+    profilerText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, 240);
+
+    // Configure game board border
+    border.setFillColor(sf::Color::Transparent);
+    border.setOutlineColor(sf::Color::White);
+    border.setOutlineThickness(2);
+    border.setSize(sf::Vector2f(BOARD_WIDTH * BLOCK_SIZE, BOARD_HEIGHT * BLOCK_SIZE));
+    border.setPosition(0, 0);
+
+    // Configure the opponent's board (versus mode only; label string is set by updateHud)
+    opponentText.setFont(assets.getFont());
+    opponentText.setCharacterSize(14);
+    opponentText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, OPPONENT_TOP - 22);
+    opponentBorder.setFillColor(sf::Color::Transparent);
+    opponentBorder.setOutlineColor(sf::Color::White);
+    opponentBorder.setOutlineThickness(1);
+    opponentBorder.setSize(sf::Vector2f(BOARD_WIDTH * OPPONENT_BLOCK_SIZE, BOARD_HEIGHT * OPPONENT_BLOCK_SIZE));
+    opponentBorder.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, OPPONENT_TOP);
+
+    // Configure versus results (shown instead of the game over message when the opponent tops out)
+    winText.setFont(assets.getFont());
+    winText.setCharacterSize(30);
+    winText.setFillColor(sf::Color::Green);
+    winText.setString("YOU WIN");
+    winText.setPosition(50, WINDOW_HEIGHT / 2);
+    drawText.setFont(assets.getFont());
+    drawText.setCharacterSize(30);
+    drawText.setFillColor(sf::Color::Yellow);
+    drawText.setString("DRAW");
+    drawText.setPosition(50, WINDOW_HEIGHT / 2);
+    if (versusPeer) {
+        restartText.setString("Press R for a rematch");
+    }
+
+    // Force every HUD string to be laid out by the first frame
+    shownSoundEnabled = !soundEnabled;
+    shownOpponentConnected = !opponentConnected.load(std::memory_order_relaxed);
 }
 
 /**
- * Generate and spawn a new random piece at the top of the board
+ * Re-layout only the HUD strings whose underlying values changed
  */
-void Tetris::spawnNewPiece() {
-    // Select random piece type (0-6)
-    currentPieceType = pieceDist(rng);
-    currentPiece = pieces[currentPieceType];
+void Tetris::updateHud(const GameSnapshot& snapshot) {
+    if (snapshot.score != shownScore) {
+        shownScore = snapshot.score;
+        scoreText.setString("Score: " + std::to_string(shownScore));
+    }
 
-    // Position piece at top-center of board
-    currentX = BOARD_WIDTH / 2 - 2;  // Center horizontally (accounting for 4-wide piece grid)
-    currentY = 0;                    // Start at top
+    if (snapshot.level != shownLevel) {
+        shownLevel = snapshot.level;
+        levelText.setString("Level: " + std::to_string(shownLevel));
+    }
 
-    // Check if spawn position is blocked (game over condition)
-    if (!isValidPosition(currentX, currentY, currentPiece)) {
-        gameOver = true;
-        playSound(gameOverSound);
+    if (snapshot.soundEnabled != shownSoundEnabled) {
+        shownSoundEnabled = snapshot.soundEnabled;
+        soundStatusText.setFillColor(shownSoundEnabled ? sf::Color::Green : sf::Color::Red);
+        soundStatusText.setString("Sound: " + std::string(shownSoundEnabled ? "ON" : "OFF"));
+    }
+
+    bool connected = opponentConnected.load(std::memory_order_relaxed);
+    if (versusPeer && connected != shownOpponentConnected) {
+        shownOpponentConnected = connected;
+        opponentText.setFillColor(connected ? sf::Color::White : sf::Color::Red);
+        opponentText.setString(connected ? "Opponent" : "Opponent left");
     }
 }
 
 /**
- * Check if a piece can be placed at the specified position without collisions
+ * Rebuild the frame stats overlay every few frames
  */
-bool Tetris::isValidPosition(int x, int y, const std::vector<std::vector<int>>& piece) {
-    // Check each block of the piece
-    for (int py = 0; py < 4; py++) {
-        for (int px = 0; px < 4; px++) {
-            // Only check non-empty blocks of the piece
-            if (piece[py][px] != 0) {
-                int boardX = x + px;
-                int boardY = y + py;
-
-                // Check boundaries and collisions
-                if (boardX < 0 || boardX >= BOARD_WIDTH ||          // Left/right boundaries
-                    boardY >= BOARD_HEIGHT ||                       // Bottom boundary
-                    (boardY >= 0 && board[boardY][boardX] != 0)) {  // Collision with existing blocks
-                    return false;
-                }
-            }
+void Tetris::updateProfilerText() {
+    if (--profilerRefreshCounter > 0) return;
+    profilerRefreshCounter = PROFILER_REFRESH_FRAMES;
+
+    static const char* const names[] = { "snapshot", "sync", "render", "present" };
+    static const FramePhase phases[] = { FramePhase::Snapshot, FramePhase::Sync, FramePhase::Render, FramePhase::Present };
+
+    auto formatRow = [](const char* name, const TimingStats& stats) {
+        char line[64];
+        std::snprintf(line, sizeof(line), "%-9s%6.2f%6.2f%6.2f%6.2f\n",
+                      name, stats.p50 / 1000, stats.p95 / 1000, stats.p99 / 1000, stats.max / 1000);
+        return std::string(line);
+    };
+
+    std::string text = "ms         p50   p95   p99   max\n";
+    for (int i = 0; i < FrameProfiler::PHASE_COUNT; i++) {
+        text += formatRow(names[i], profiler.getStats(phases[i]));
+    }
+    TimingStats frame = profiler.getFrameStats();
+    text += formatRow("frame", frame);
+    text += formatRow("jitter", profiler.getJitterStats());
+    text += formatRow("step", profiler.getStepStats());
+    text += formatRow("tick late", profiler.getTickLatenessStats());
+    if (frame.mean > 0) {
+        text += "fps " + std::to_string(static_cast<int>(1000000 / frame.mean + 0.5f)) + "  ";
+    }
+    text += FramePacer::modeName(pacer.getSettings().mode);
+
+    // Music synthesis cost per buffer against the buffer's playback time
+    MusicLoad load = music.takeLoad();
+    char line[64];
+    std::snprintf(line, sizeof(line), "\nmusic %.0fus (peak %.0f) / %.1fms",
+                  load.lastUs, load.peakUs, load.bufferUs / 1000);
+    text += line;
+    profilerText.setString(text);
+}
+
+/**
+ * Play the sound effects matching the events raised by the engine
+ */
+void Tetris::playEventSounds(unsigned events) {
+    if (events & EngineEvent::Move) playSound(SoundEffect::Move);
+    if (events & EngineEvent::Rotate) playSound(SoundEffect::Rotate);
+    if (events & EngineEvent::Drop) playSound(SoundEffect::Drop);
+    if (events & EngineEvent::LineClear) playSound(SoundEffect::LineClear);
+
+    // Play level up sound if level increased, shortly after the line clear chime.
+    // The delay is scheduled rather than slept so the game keeps running.
+    if (events & EngineEvent::LevelUp) {
+        playSoundAfter(SoundEffect::LevelUp, sf::milliseconds(200));
+    }
+
+    if (events & EngineEvent::GameOver) playSound(SoundEffect::GameOver);
+}
+
+/**
+ * Apply a player action and record it if it changed the game
+ */
+void Tetris::applyAction(Action action) {
+    if (replayPlayer) return;  // The replay is in control
+
+    // Rejected actions have no effect on the game, so only accepted ones are recorded
+    if (engine.step(action)) {
+        recording.record(engine.getTickCount(), action);
+        snapshotDirty = true;
+    }
+}
+
+/**
+ * Compare each bound key with its previous sample and report the changes
+ */
+void Tetris::sampleKeys() {
+    // sf::Keyboard reads the global keyboard state, so ignore it while another window has focus
+    bool focused = windowFocused.load(std::memory_order_relaxed);
+
+    for (const KeyBinding& binding : KEY_BINDINGS) {
+        bool& held = keysHeld[static_cast<int>(binding.key)];
+        bool down = focused && sf::Keyboard::isKeyPressed(binding.code);
+        if (down == held) continue;
+
+        held = down;
+        if (down) {
+            input.press(binding.key);
         }
+        else {
+            input.release(binding.key);
+        }
+        applyInputCommands();
     }
-    return true;
 }
 
 /**
- * Permanently place the current piece on the game board
+ * Apply the toggles posted by the main thread
  */
-void Tetris::placePiece() {
-    // Transfer each block of the current piece to the board
-    for (int py = 0; py < 4; py++) {
-        for (int px = 0; px < 4; px++) {
-            if (currentPiece[py][px] != 0) {
-                int boardX = currentX + px;
-                int boardY = currentY + py;
-
-                // Only place blocks that are within the visible board area
-                if (boardY >= 0) {
-                    board[boardY][boardX] = currentPiece[py][px];
-                }
-            }
+void Tetris::handleRequests() {
+    unsigned requests = pendingRequests.exchange(0, std::memory_order_relaxed);
+    if (requests == 0) return;
+
+    // Toggle attract/demo mode (not while watching a replay or playing versus)
+    if ((requests & ToggleDemo) && !replayPlayer && !match) {
+        demoMode = !demoMode;
+        demoCounter = 0;
+        std::cout << "Demo mode " << (demoMode ? "on" : "off") << std::endl;
+    }
+
+    // Toggle sound on/off
+    if ((requests & ToggleSound) && !engine.isGameOver()) {
+        soundEnabled = !soundEnabled;
+        if (!soundEnabled) {
+            audioCues.clear();  // Don't let pending cues play after muting
         }
+        std::cout << "Sound " << (soundEnabled ? "enabled" : "disabled") << std::endl;
+        updateMusicPlayback();
     }
 
-    // Play drop sound when piece is placed
-    playSound(dropSound);
+    snapshotDirty = true;
 }
 
 /**
- * Check for complete lines and clear them, updating score and level
+ * Copy the engine state into the back buffer and hand it to the render thread
  */
-void Tetris::clearLines() {
-    int clearedCount = 0;
-    int previousLevel = level;
-
-    // Scan from bottom to top for complete lines
-    for (int y = BOARD_HEIGHT - 1; y >= 0; y--) {
-        bool fullLine = true;
-
-        // Check if this line is completely filled
-        for (int x = 0; x < BOARD_WIDTH; x++) {
-            if (board[y][x] == 0) {
-                fullLine = false;
-                break;
-            }
+void Tetris::publishSnapshot() {
+    if (!snapshotDirty) return;
+    snapshotDirty = false;
+
+    // Stamped with the time of the latest tick so the renderer extrapolates gravity from there
+    GameSnapshot& snapshot = snapshots.back();
+    snapshot.capture(engine, lastTickTime);
+    snapshot.soundEnabled = soundEnabled;
+    snapshot.demoMode = demoMode;
+    snapshots.publish();
+
+    if (match) {
+        GameSnapshot& opponentSnapshot = opponentSnapshots.back();
+        opponentSnapshot.capture(opponent, lastTickTime);
+        opponentSnapshot.soundEnabled = soundEnabled;
+        opponentSnapshot.demoMode = false;
+        opponentSnapshots.publish();
+    }
+}
+
+/**
+ * Apply the controller's commands, resolving "as far as possible" with the engine
+ */
+void Tetris::applyInputCommands() {
+    InputCommand commands[InputController::MAX_COMMANDS];
+    int count = input.takeCommands(commands);
+
+    for (int i = 0; i < count; i++) {
+        Action action = commands[i].action;
+        int repeats = commands[i].count;
+        if (repeats == InputController::AS_FAR_AS_POSSIBLE) {
+            int dx = action == Action::MoveLeft ? -1 : action == Action::MoveRight ? 1 : 0;
+            int dy = action == Action::SoftDrop ? 1 : 0;
+            repeats = engine.isGameOver() ? 0 : engine.getTravelDistance(dx, dy);
+        }
+        for (int r = 0; r < repeats; r++) {
+            applyAction(action);
         }
+    }
+}
+
+/**
+ * OR the keys down now into the byte, so a tap between two ticks isn't lost
+ */
+void Tetris::sampleVersusKeys() {
+    // sf::Keyboard reads the global keyboard state, so ignore it while another window has focus
+    if (!windowFocused.load(std::memory_order_relaxed)) return;
 
-        if (fullLine) {
-            // Remove the complete line and add empty line at top
-            board.erase(board.begin() + y);
-            board.insert(board.begin(), std::vector<int>(BOARD_WIDTH, 0));
-            clearedCount++;
-            y++; // Re-check the same line index since we shifted everything down
+    for (const KeyBinding& binding : KEY_BINDINGS) {
+        if (sf::Keyboard::isKeyPressed(binding.code)) {
+            versusKeys |= VersusMatch::keyBit(binding.key);
         }
     }
+}
 
-    // Update game state if any lines were cleared
-    if (clearedCount > 0) {
-        linesCleared += clearedCount;
+/**
+ * Send this tick's buttons for a later tick, then run the tick if the opponent's have arrived
+ */
+bool Tetris::advanceVersus() {
+    uint32_t tick = match->getTick();
 
-        // Score calculation: more lines cleared simultaneously = higher score multiplier
-        score += clearedCount * 100 * level;
+    if (versusPeer->needsLocalInput(tick)) {
+        versusPeer->submitLocalInput(versusKeys);
 
-        // Level increases every 10 lines cleared
-        level = 1 + linesCleared / 10;
+        // Start the next byte from what is still held
+        versusKeys = 0;
+        sampleVersusKeys();
+    }
 
-        // Increase drop speed with level (minimum 50ms interval)
-        dropInterval = std::max(50.0f, 500.0f - (level - 1) * 50.0f);
+    if (!versusPeer->hasInputs(tick)) return false;
 
-        // Play appropriate sound effects
-        playSound(lineClearSound);
+    uint8_t keys[VersusMatch::PLAYER_COUNT];
+    versusPeer->takeInputs(tick, keys);
+    match->advance(keys);
 
-        // Play level up sound if level increased
-        if (level > previousLevel) {
-            // Small delay before level up sound
-            sf::sleep(sf::milliseconds(200));
-            playSound(levelUpSound);
-        }
+    if (match->getTick() % LockstepPeer::CHECK_INTERVAL == 0) {
+        versusPeer->submitChecksum(match->getTick(), match->getHash());
     }
+    return true;
 }
 
 /**
- * Rotate a piece 90 degrees clockwise using matrix rotation
+ * Play one demo tick: replan from the current position and take one step
  */
-std::vector<std::vector<int>> Tetris::rotatePiece(const std::vector<std::vector<int>>& piece) {
-    std::vector<std::vector<int>> rotated(4, std::vector<int>(4, 0));
-
-    // Apply rotation transformation: (x,y) -> (y, 3-x)
-    for (int y = 0; y < 4; y++) {
-        for (int x = 0; x < 4; x++) {
-            rotated[x][3 - y] = piece[y][x];
+void Tetris::runDemoTick() {
+    demoCounter++;
+
+    // Leave the game over screen up for a moment, then start again
+    if (engine.isGameOver()) {
+        if (demoCounter >= DEMO_RESTART_TICKS) {
+            demoCounter = 0;
+            applyAction(Action::Restart);
         }
+        return;
     }
 
-    return rotated;
+    if (demoCounter < DEMO_TICKS_PER_ACTION) return;
+    demoCounter = 0;
+
+    // Replanning every action keeps the path valid even though gravity keeps pulling the piece;
+    // the transposition table makes each replan mostly revisit cached lookahead nodes
+    SearchLimits limits;
+    limits.maxDepth = DEMO_SEARCH_DEPTH;
+    limits.timeBudgetUs = DEMO_SEARCH_BUDGET_US;
+    AIMove move = ai.findBestMove(engine, limits);
+    if (!move.found || move.path.empty()) return;  // Already resting - gravity will lock it
+
+    bool onlyDropsLeft = std::all_of(move.path.begin(), move.path.end(),
+                                     [](Action action) { return action == Action::SoftDrop; });
+    applyAction(onlyDropsLeft ? Action::HardDrop : move.path.front());
 }
 
 /**
- * Handle all user input and window events
+ * Handle a window event on the main thread
  */
-void Tetris::handleInput() {
-    sf::Event event;
+bool Tetris::handleInput(const sf::Event& event) {
+    // Handle window close event
+    if (event.type == sf::Event::Closed) {
+        return false;
+    }
 
-    while (window.pollEvent(event)) {
-        // Handle window close event
-        if (event.type == sf::Event::Closed) {
-            window.close();
-        }
+    // Held keys would never read as released once focus is gone
+    if (event.type == sf::Event::LostFocus) {
+        windowFocused.store(false, std::memory_order_relaxed);
+    }
+    if (event.type == sf::Event::GainedFocus) {
+        windowFocused.store(true, std::memory_order_relaxed);
+    }
 
-        // Handle gameplay input (only when game is active)
-        if (event.type == sf::Event::KeyPressed && !gameOver) {
-            switch (event.key.code) {
-            case sf::Keyboard::Left:
-                // Move piece left if possible
-                if (isValidPosition(currentX - 1, currentY, currentPiece)) {
-                    currentX--;
-                    playSound(moveSound);
-                }
-                break;
-
-            case sf::Keyboard::Right:
-                // Move piece right if possible
-                if (isValidPosition(currentX + 1, currentY, currentPiece)) {
-                    currentX++;
-                    playSound(moveSound);
-                }
-                break;
-
-            case sf::Keyboard::Down:
-                // Soft drop - move piece down faster for small score bonus
-                if (isValidPosition(currentX, currentY + 1, currentPiece)) {
-                    currentY++;
-                    score += 1;  // Small bonus for manual dropping
-                    playSound(moveSound);
-                }
-                break;
-
-            case sf::Keyboard::Up:
-                // Rotate piece clockwise if possible
-            {
-                auto rotated = rotatePiece(currentPiece);
-                if (isValidPosition(currentX, currentY, rotated)) {
-                    currentPiece = rotated;
-                    playSound(rotateSound);
-                }
-            }
+    // The window contents may need repainting even though the game didn't change
+    if (event.type == sf::Event::Resized || event.type == sf::Event::GainedFocus) {
+        redrawRequested.store(true, std::memory_order_relaxed);
+    }
+
+    // Gameplay keys are sampled by the simulation thread; only the toggles are events
+    if (event.type == sf::Event::KeyPressed) {
+        switch (event.key.code) {
+        case sf::Keyboard::A:
+            pendingRequests.fetch_or(ToggleDemo, std::memory_order_relaxed);
             break;
 
-            case sf::Keyboard::Space:
-                // Hard drop - instantly drop piece to bottom
-                while (isValidPosition(currentX, currentY + 1, currentPiece)) {
-                    currentY++;
-                    score += 2;  // Higher bonus for hard drop
-                }
-                playSound(dropSound);
-                break;
-
-            case sf::Keyboard::M:
-                // Toggle sound on/off
-                soundEnabled = !soundEnabled;
-                std::cout << "Sound " << (soundEnabled ? "enabled" : "disabled") << std::endl;
-                break;
-            }
-        }
+        case sf::Keyboard::M:
+            pendingRequests.fetch_or(ToggleSound, std::memory_order_relaxed);
+            break;
 
-        // Handle game over input
-        if (event.type == sf::Event::KeyPressed && gameOver) {
-            if (event.key.code == sf::Keyboard::R) {
-                // Restart game - reset all game state
-                board = std::vector<std::vector<int>>(BOARD_HEIGHT, std::vector<int>(BOARD_WIDTH, 0));
-                score = 0;
-                level = 1;
-                linesCleared = 0;
-                gameOver = false;
-                dropInterval = 500.0f;
-                spawnNewPiece();
-            }
+        case sf::Keyboard::F3:
+            // Toggle the frame stats overlay
+            showProfiler.store(!showProfiler.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            redrawRequested.store(true, std::memory_order_relaxed);
+            break;
+
+        default:
+            break;
         }
     }
+    return true;
+}
+
+/**
+ * Simulation thread - step the game at a millisecond cadence until stopped
+ */
+void Tetris::simulationLoop() {
+    lastUpdateTime = clock.getElapsedTime().asMicroseconds();
+    lastTickTime = lastUpdateTime;
+    updateMusicState();
+    updateMusicPlayback();
+
+    while (running.load(std::memory_order_acquire)) {
+        update();
+        sf::sleep(sf::microseconds(INPUT_POLL_US));
+    }
+
+    music.stop();
+    mixerOutput.stop();
+
+    // Let the opponent know right away instead of after a timeout
+    if (versusPeer) {
+        versusPeer->disconnect();
+    }
 }
 
 /**
- * Update game state each frame
+ * Bring the game up to the current time
  */
 void Tetris::update() {
-    // Don't update game logic if game is over
-    if (gameOver) return;
-
-    // Handle automatic piece dropping based on timing
-    float deltaTime = clock.restart().asMilliseconds();
-    dropTimer += deltaTime;
-
-    // Check if it's time to drop the piece automatically
-    if (dropTimer >= dropInterval) {
-        if (isValidPosition(currentX, currentY + 1, currentPiece)) {
-            // Piece can fall further
-            currentY++;
+    profiler.beginStep();
+    handleRequests();
+
+    // New presses take effect at once, between ticks; in versus they wait for the next button byte
+    if (match) {
+        versusPeer->poll();
+        sampleVersusKeys();
+    }
+    else if (!replayPlayer) {
+        sampleKeys();
+    }
+
+    // Bank the real time that passed, scaled by TICK_RATE so that one tick is
+    // exactly one second's worth of microseconds and no time is ever lost
+    sf::Int64 now = clock.getElapsedTime().asMicroseconds();
+    tickAccumulator += (now - lastUpdateTime) * TetrisEngine::TICK_RATE;
+    lastUpdateTime = now;
+
+    // How long the oldest due tick has been waiting; more than a poll interval means the thread was held up
+    float tickLateness = -1;
+    if (tickAccumulator >= MICROSECONDS_PER_SECOND) {
+        tickLateness = static_cast<float>(tickAccumulator - MICROSECONDS_PER_SECOND) / TetrisEngine::TICK_RATE;
+    }
+
+    // Run as many whole simulation ticks as have elapsed, catching up if the thread was held up
+    int ticksRun = 0;
+    while (tickAccumulator >= MICROSECONDS_PER_SECOND && ticksRun < MAX_TICKS_PER_FRAME) {
+        if (match) {
+            // Both boards stand still until the opponent's buttons arrive; the backlog is dropped below
+            if (!advanceVersus()) break;
+        }
+        else if (replayPlayer) {
+            replayPlayer->advance(engine);
         }
         else {
-            // Piece has landed - place it, clear lines, and spawn new piece
-            placePiece();
-            clearLines();
-            spawnNewPiece();
+            if (demoMode) {
+                runDemoTick();
+            }
+            input.tick();
+            applyInputCommands();
+            engine.tick();
         }
-        dropTimer = 0;  // Reset drop timer
+        tickAccumulator -= MICROSECONDS_PER_SECOND;
+        ticksRun++;
     }
+
+    // Still behind after a very long stall - drop the backlog rather than fast-forwarding the game
+    if (tickAccumulator >= MICROSECONDS_PER_SECOND) {
+        tickAccumulator = 0;
+    }
+
+    if (match) {
+        versusPeer->flush();
+
+        if (!versusPeer->isConnected() && opponentConnected.load(std::memory_order_relaxed)) {
+            opponentConnected.store(false, std::memory_order_relaxed);
+            std::cout << "Opponent left the match" << std::endl;
+            snapshotDirty = true;
+        }
+        if (versusPeer->isDesynced() && !desyncReported) {
+            desyncReported = true;
+            std::cout << "Warning: versus boards out of sync at tick " << match->getTick() << std::endl;
+        }
+    }
+
+    if (ticksRun > 0) {
+        lastTickTime = now - tickAccumulator / TetrisEngine::TICK_RATE;
+        snapshotDirty = true;
+        updateMusicState();
+    }
+
+    // Sounds finish loading in the background; until then the effects are silent
+    if (!soundsAttached && assets.soundsReady()) {
+        attachSounds();
+    }
+
+    // Play sounds for everything that happened this step, then any delayed cues now due
+    playEventSounds(engine.consumeEvents());
+    audioCues.update(mixer);
+
+    publishSnapshot();
+    profiler.endStep(ticksRun > 0 ? tickLateness : -1);
 }
 
 /**
- * Render all game graphics to the screen
+ * Render thread - draw frames until stopped
  */
-void Tetris::render() {
-    // Clear screen with black background
-    window.clear(sf::Color::Black);
+void Tetris::renderLoop() {
+    window.setActive(true);
+
+    while (running.load(std::memory_order_acquire)) {
+        render();
+        profiler.endFrame();
+    }
 
-    // Create a rectangle shape for drawing blocks
-    sf::RectangleShape block(sf::Vector2f(BLOCK_SIZE - 1, BLOCK_SIZE - 1));  // -1 for grid lines
+    window.setActive(false);
+}
+
+/**
+ * Render the latest snapshot to the screen
+ */
+void Tetris::render() {
+    // Switch to the newest snapshot, or keep drawing the current one
+    bool changed = snapshots.acquire();
+    if (versusPeer) {
+        changed |= opponentSnapshots.acquire();
+    }
 
-    // Draw all placed pieces on the board
-    for (int y = 0; y < BOARD_HEIGHT; y++) {
-        for (int x = 0; x < BOARD_WIDTH; x++) {
-            if (board[y][x] != 0) {
-                block.setFillColor(colors[board[y][x]]);
-                block.setPosition(x * BLOCK_SIZE, y * BLOCK_SIZE);
-                window.draw(block);
+    // On-change pacing: idle until there is something new to show (a sliding piece
+    // changes every frame, so it keeps drawing while one is falling)
+    if (pacer.rendersOnlyOnChange()) {
+        while (!changed && !redrawRequested.exchange(false, std::memory_order_relaxed) &&
+               !(smoothFall && snapshots.front().canFall) && running.load(std::memory_order_relaxed)) {
+            sf::sleep(sf::milliseconds(1));
+            changed = snapshots.acquire();
+            if (versusPeer) {
+                changed |= opponentSnapshots.acquire();
             }
         }
     }
 
-    // Draw the currently falling piece (if game is active)
-    if (!gameOver) {
-        for (int py = 0; py < 4; py++) {
-            for (int px = 0; px < 4; px++) {
-                if (currentPiece[py][px] != 0) {
-                    block.setFillColor(colors[currentPiece[py][px]]);
-                    block.setPosition((currentX + px) * BLOCK_SIZE, (currentY + py) * BLOCK_SIZE);
-                    window.draw(block);
-                }
-            }
+    const GameSnapshot& snapshot = snapshots.front();
+    profiler.mark(FramePhase::Snapshot);
+
+    // Sync the placed blocks and the falling piece (between rows if smoothing) and the HUD text
+    float fallOffset = smoothFall ? snapshot.fallFraction(clock.getElapsedTime().asMicroseconds()) : 0;
+    boardRenderer.update(snapshot, colors, fallOffset);
+    if (versusPeer) {
+        opponentRenderer.update(opponentSnapshots.front(), colors);
+    }
+    updateHud(snapshot);
+
+    bool overlayVisible = showProfiler.load(std::memory_order_relaxed);
+    if (overlayVisible) {
+        if (!profilerShown) {
+            profilerRefreshCounter = 0;  // Fill it in right away
         }
+        updateProfilerText();
     }
+    profilerShown = overlayVisible;
+    profiler.mark(FramePhase::Sync);
+
+    // Clear screen with black background
+    window.clear(sf::Color::Black);
+
+    // Draw all placed blocks and the falling piece in a single batch
+    window.draw(boardRenderer);
 
     // Draw game board border
-    sf::RectangleShape border;
-    border.setFillColor(sf::Color::Transparent);
-    border.setOutlineColor(sf::Color::White);
-    border.setOutlineThickness(2);
-    border.setSize(sf::Vector2f(BOARD_WIDTH * BLOCK_SIZE, BOARD_HEIGHT * BLOCK_SIZE));
-    border.setPosition(0, 0);
     window.draw(border);
 
-    // Update and draw UI text
-    scoreText.setString("Score: " + std::to_string(score));
-    levelText.setString("Level: " + std::to_string(level));
+    // Draw the HUD text
     window.draw(scoreText);
     window.draw(levelText);
-
-    // Draw sound status
-    sf::Text soundStatusText;
-    soundStatusText.setFont(font);
-    soundStatusText.setCharacterSize(16);
-    soundStatusText.setFillColor(soundEnabled ? sf::Color::Green : sf::Color::Red);
-    soundStatusText.setString("Sound: " + std::string(soundEnabled ? "ON" : "OFF"));
-    soundStatusText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, 70);
     window.draw(soundStatusText);
 
-    // Draw controls help
-    sf::Text controlsText;
-    controlsText.setFont(font);
-    controlsText.setCharacterSize(14);
-    controlsText.setFillColor(sf::Color::White);
-    controlsText.setString("Controls:\nArrows: Move\nUp: Rotate\nSpace: Hard Drop\nM: Toggle Sound");
-    controlsText.setPosition(BOARD_WIDTH * BLOCK_SIZE + 10, 100);
-    window.draw(controlsText);
-
-    // Draw game over screen if applicable
-    if (gameOver) {
-        window.draw(gameOverText);
-
-        // Draw restart instruction
-        sf::Text restartText;
-        restartText.setFont(font);
-        restartText.setCharacterSize(20);
-        restartText.setFillColor(sf::Color::White);
-        restartText.setString("Press R to restart");
-        restartText.setPosition(50, WINDOW_HEIGHT / 2 + 40);
+    // Draw the baked controls help
+    if (controlsBaked) {
+        window.draw(controlsSprite);
+    }
+    else {
+        window.draw(controlsText);
+    }
+
+    // Draw frame stats overlay if enabled
+    if (overlayVisible) {
+        window.draw(profilerText);
+    }
+
+    // Draw the opponent's board below the HUD
+    if (versusPeer) {
+        window.draw(opponentRenderer, sf::Transform().translate(BOARD_WIDTH * BLOCK_SIZE + 10, OPPONENT_TOP));
+        window.draw(opponentBorder);
+        window.draw(opponentText);
+    }
+
+    // Draw game over screen if applicable; in versus the round also ends when the opponent tops out
+    bool opponentOver = versusPeer && opponentSnapshots.front().gameOver;
+    if (snapshot.gameOver || opponentOver) {
+        if (!opponentOver) {
+            window.draw(gameOverText);
+        }
+        else {
+            window.draw(snapshot.gameOver ? drawText : winText);
+        }
         window.draw(restartText);
     }
 
-    // Display everything on screen
+    // Display everything on screen once the frame is due (vsync waits inside display())
+    profiler.mark(FramePhase::Render);
+    pacer.waitForDeadline();
     window.display();
+    profiler.mark(FramePhase::Present);
 }
 
 /**
  * Main game loop - runs until window is closed
  */
 void Tetris::run() {
-    while (window.isOpen()) {
-        handleInput();  // Process user input
-        update();       // Update game state
-        render();       // Draw everything
+    // The render thread takes over the window's OpenGL context
+    window.setActive(false);
+    running.store(true, std::memory_order_release);
+    std::thread simulationThread(&Tetris::simulationLoop, this);
+    std::thread renderThread(&Tetris::renderLoop, this);
+
+    // Window events must be handled on the thread that created the window
+    sf::Event event;
+    while (window.waitEvent(event) && handleInput(event)) {
+    }
+
+    running.store(false, std::memory_order_release);
+    renderThread.join();
+    simulationThread.join();
+    window.close();
+
+    // Save the session so it can be reproduced later
+    if (!recordPath.empty()) {
+        recording.finish(engine.getTickCount());
+        if (recording.saveToFile(recordPath)) {
+            std::cout << "Saved replay to: " << recordPath << std::endl;
+        }
+        else {
+            std::cout << "Warning: Could not save replay to: " << recordPath << std::endl;
+        }
     }
-}
\ No newline at end of file
+
+    // Save the frame timings for offline analysis
+    if (!profilePath.empty()) {
+        if (profiler.saveToFile(profilePath)) {
+            std::cout << "Saved frame timings (" << profiler.getFrameCount() << " frames) to: " << profilePath << std::endl;
+        }
+        else {
+            std::cout << "Warning: Could not save frame timings to: " << profilePath << std::endl;
+        }
+    }
+}
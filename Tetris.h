@@ -1,194 +1,375 @@
 #pragma once
 
+#include "TetrisEngine.h"
+#include "BoardRenderer.h"
+#include "AudioCueScheduler.h"
+#include "SoundMixer.h"
+#include "MixerStream.h"
+#include "MusicStream.h"
+#include "Replay.h"
+#include "TetrisAI.h"
+#include "FrameProfiler.h"
+#include "InputController.h"
+#include "GameSnapshot.h"
+#include "FramePacer.h"
+#include "TripleBuffer.h"
+#include "AssetLoader.h"
+#include "VersusMatch.h"
+#include "LockstepPeer.h"
 #include <SFML/Graphics.hpp>
 #include <SFML/Audio.hpp>
 #include <vector>
-#include <random>
-#include <chrono>
+#include <string>
+#include <memory>
+#include <atomic>
+
+/**
+ * @brief Startup settings for a Tetris session
+ */
+struct GameOptions {
+    uint32_t seed = 0;                          ///< Seed for the piece sequence
+    std::string recordPath;                     ///< Save a replay of the session here on exit (empty = don't record)
+    const Replay* playback = nullptr;           ///< Replay to play back in real time instead of taking input
+    bool demo = false;                          ///< Start in attract/demo mode with the AI playing
+    std::string profilePath;                    ///< Save frame timings here on exit (.json = summary, else CSV; empty = don't)
+    InputSettings input;                        ///< DAS / ARR / soft drop timing
+    bool smoothFall = false;                    ///< Draw the falling piece between rows as gravity pulls it
+    PacingSettings pacing;                      ///< When the render thread presents frames
+    bool music = true;                          ///< Play the procedural background music
+    int mixerBufferFrames = MixerStream::DEFAULT_BUFFER_FRAMES;  ///< Sound effect mixer buffer size in samples (sets effect latency)
+    std::string assetPack = AssetLoader::DEFAULT_PACK_PATH;  ///< Asset pack to load from if present (empty = loose files only)
+    LockstepPeer* versus = nullptr;             ///< Play a versus match against this connected peer (seed must be the peer's)
+};
 
 /**
  * @brief Main Tetris game class
  *
- * This class handles all game logic, rendering, input, and audio for a complete Tetris implementation.
- * It manages the game board, pieces, scoring, user interface, and sound effects.
+ * This class handles rendering, input, and audio for a complete Tetris implementation.
+ * The game rules themselves live in TetrisEngine, which this class wraps for display.
+ *
+ * Three threads share the work. The main thread owns the window and handles
+ * its events. The simulation thread samples the keyboard about once a
+ * millisecond, runs the engine at the fixed tick rate, plays sounds and
+ * publishes a GameSnapshot after every change. The render thread draws the
+ * latest snapshot and waits in window.display(). Snapshots travel through a
+ * lock-free TripleBuffer and the other handoffs are atomics, so a slow or
+ * blocked frame never delays input or gravity.
  */
 class Tetris {
 private:
     // Game constants
-    static const int BOARD_WIDTH = 10;          ///< Width of the game board in blocks
-    static const int BOARD_HEIGHT = 20;         ///< Height of the game board in blocks
+    static const int BOARD_WIDTH = TetrisEngine::BOARD_WIDTH;   ///< Width of the game board in blocks
+    static const int BOARD_HEIGHT = TetrisEngine::BOARD_HEIGHT; ///< Height of the game board in blocks
     static const int BLOCK_SIZE = 30;           ///< Size of each block in pixels
     static const int WINDOW_WIDTH = BOARD_WIDTH * BLOCK_SIZE + 200;   ///< Total window width
     static const int WINDOW_HEIGHT = BOARD_HEIGHT * BLOCK_SIZE + 100; ///< Total window height
+    static const int MAX_TICKS_PER_FRAME = 8;   ///< Catch-up limit for simulation ticks in one simulation step
+    static const int DEMO_TICKS_PER_ACTION = 4; ///< Ticks between AI actions in demo mode
+    static const int DEMO_RESTART_TICKS = 180;  ///< Ticks the game over screen stays up in demo mode
+    static const int DEMO_SEARCH_DEPTH = 3;     ///< Pieces the demo AI looks ahead
+    static const int DEMO_SEARCH_BUDGET_US = 4000;  ///< Demo AI time budget per decision (a quarter frame)
+    static const int INPUT_POLL_US = 1000;      ///< Simulation thread's keyboard sampling interval
+    static const int PROFILER_REFRESH_FRAMES = 30;  ///< Frames between frame stats overlay updates
+    static const int OPPONENT_BLOCK_SIZE = 12;  ///< Size of the opponent's blocks in pixels
+    static const int OPPONENT_TOP = 440;        ///< Top of the opponent's board in pixels
+    static const sf::Int64 MICROSECONDS_PER_SECOND = 1000000;
 
-    // Game board representation
-    std::vector<std::vector<int>> board;        ///< 2D grid representing the game board (0 = empty, >0 = color index)
+    /**
+     * @brief Requests from the main thread to the simulation thread (bit flags)
+     */
+    enum SimulationRequest : unsigned {
+        ToggleDemo  = 1u << 0,                  ///< Turn demo mode on or off
+        ToggleSound = 1u << 1                   ///< Mute or unmute sound effects
+    };
 
-    // Tetromino piece definitions
-    std::vector<std::vector<std::vector<int>>> pieces;  ///< All 7 Tetris piece shapes in 4x4 grids
-    std::vector<sf::Color> colors;              ///< Color mapping for each piece type
+    // Thread handoff
+    std::atomic<bool> running;                  ///< Cleared by the main thread to stop the other threads
+    std::atomic<bool> windowFocused;            ///< Keys are only sampled while the window has focus
+    std::atomic<unsigned> pendingRequests;      ///< SimulationRequest flags not handled yet
+    std::atomic<bool> showProfiler;             ///< Whether the frame stats overlay is visible
+    std::atomic<bool> redrawRequested;          ///< Draw a frame even if the game state didn't change (on-change pacing)
+    TripleBuffer<GameSnapshot> snapshots;       ///< Simulation -> render state handoff
+    TripleBuffer<GameSnapshot> opponentSnapshots;  ///< Simulation -> render handoff of the opponent's board in versus mode
+    std::atomic<bool> opponentConnected;        ///< Cleared once the versus opponent leaves or times out
+
+    // ---- Owned by the simulation thread ----
 
-    // Current active piece state
-    std::vector<std::vector<int>> currentPiece; ///< Currently falling piece shape
-    int currentX;                               ///< X position of current piece on board
-    int currentY;                               ///< Y position of current piece on board
-    int currentPieceType;                       ///< Type index of current piece (0-6)
+    // Game rules and state
+    TetrisEngine engine;                        ///< Headless simulation core
 
-    // Game state variables
-    int score;                                  ///< Current player score
-    int level;                                  ///< Current difficulty level
-    int linesCleared;                          ///< Total lines cleared (used for level calculation)
-    bool gameOver;                             ///< Flag indicating if game has ended
+    // Replays
+    Replay recording;                           ///< Accepted inputs of this session
+    std::string recordPath;                     ///< Where to save the recording on exit (empty = don't)
+    std::unique_ptr<ReplayPlayer> replayPlayer; ///< Drives the engine during playback (null when playing live)
+
+    // Versus mode
+    LockstepPeer* versusPeer;                  ///< Connection to the opponent (null in single player)
+    TetrisEngine opponent;                     ///< Opponent's board, driven by the buttons they send
+    std::unique_ptr<VersusMatch> match;        ///< Runs both boards in lockstep (null in single player)
+    uint8_t versusKeys;                        ///< Buttons held or pressed since the last byte was sent
+    bool desyncReported;                       ///< Whether the out of sync warning was printed
+
+    // Attract/demo mode
+    TetrisAI ai;                                ///< Placement search playing in demo mode
+    bool demoMode;                              ///< Whether the AI is playing
+    int demoCounter;                            ///< Ticks since the AI's last action
 
     // Timing control
-    sf::Clock clock;                           ///< SFML clock for timing
-    float dropTimer;                           ///< Timer for automatic piece dropping
-    float dropInterval;                        ///< Interval between automatic drops (decreases with level)
+    sf::Clock clock;                           ///< Time base shared by all threads (never restarted)
+    sf::Int64 lastUpdateTime;                  ///< Clock time of the previous simulation step in microseconds
+    sf::Int64 lastTickTime;                    ///< Clock time the latest tick was due at in microseconds
+    sf::Int64 tickAccumulator;                 ///< Unsimulated time in microseconds x TICK_RATE
+    bool snapshotDirty;                        ///< Whether the engine may differ from the last published snapshot
+
+    // Player input
+    InputController input;                     ///< DAS / ARR auto-repeat, advanced once per tick
+    bool keysHeld[InputController::KEY_COUNT]; ///< Key state at the previous sample, per InputKey
+
+    // ---- Owned by the render thread ----
+
+    std::vector<sf::Color> colors;              ///< Color mapping for each piece type
+    bool smoothFall;                           ///< Whether the falling piece is drawn between rows
+    FramePacer pacer;                          ///< Decides when frames are presented
+
+    // Frame profiling (the simulation thread only reports its steps through beginStep/endStep)
+    FrameProfiler profiler;                    ///< Per-phase timings of the render loop and the simulation steps
+    std::string profilePath;                   ///< Where to save the timings on exit (empty = don't)
+    bool profilerShown;                        ///< Overlay visibility at the previous frame
+    int profilerRefreshCounter;                ///< Frames until the overlay text is refreshed
 
-    // Graphics and UI
+    // Font and sounds, loading in the background from construction on (before the window is created)
+    AssetLoader assets;                        ///< Background font and sound loader
+
+    // Graphics and UI (the window itself belongs to the main thread, its drawing to the render thread)
     sf::RenderWindow window;                   ///< Main game window
-    sf::Font font;                             ///< Font for text rendering
+    BoardRenderer boardRenderer;               ///< Batched block renderer for board and falling piece
     sf::Text scoreText;                        ///< Score display text
     sf::Text levelText;                        ///< Level display text
     sf::Text gameOverText;                     ///< Game over message text
+    sf::Text restartText;                      ///< Restart instruction text
+    sf::Text soundStatusText;                  ///< Sound on/off status text
+    sf::Text controlsText;                     ///< Controls help text (fallback if baking fails)
+    sf::Text profilerText;                     ///< Frame stats overlay text
+    sf::RenderTexture controlsTexture;         ///< Controls help pre-rendered once at startup
+    sf::Sprite controlsSprite;                 ///< Sprite showing the baked controls help
+    sf::RectangleShape border;                 ///< Game board border
+    BoardRenderer opponentRenderer;            ///< Opponent's board, drawn small below the HUD in versus mode
+    sf::RectangleShape opponentBorder;         ///< Opponent's board border
+    sf::Text opponentText;                     ///< Label above the opponent's board
+    sf::Text winText;                          ///< Versus message when the opponent tops out first
+    sf::Text drawText;                         ///< Versus message when both players top out on the same tick
+    bool controlsBaked;                        ///< Whether controlsTexture holds the controls help
 
-    // Audio system
-    sf::SoundBuffer moveBuffer;                ///< Sound buffer for piece movement
-    sf::SoundBuffer rotateBuffer;              ///< Sound buffer for piece rotation
-    sf::SoundBuffer dropBuffer;                ///< Sound buffer for piece drop/landing
-    sf::SoundBuffer lineClearBuffer;           ///< Sound buffer for line clearing
-    sf::SoundBuffer gameOverBuffer;            ///< Sound buffer for game over
-    sf::SoundBuffer levelUpBuffer;             ///< Sound buffer for level up
-
-    sf::Sound moveSound;                       ///< Sound object for movement
-    sf::Sound rotateSound;                     ///< Sound object for rotation
-    sf::Sound dropSound;                       ///< Sound object for dropping
-    sf::Sound lineClearSound;                  ///< Sound object for line clearing
-    sf::Sound gameOverSound;                   ///< Sound object for game over
-    sf::Sound levelUpSound;                    ///< Sound object for level up
+    // Retained HUD state (text is only re-laid-out when these differ from the snapshot)
+    int shownScore;                            ///< Score currently shown by scoreText
+    int shownLevel;                            ///< Level currently shown by levelText
+    bool shownSoundEnabled;                    ///< Sound state currently shown by soundStatusText
+    bool shownOpponentConnected;               ///< Opponent state currently shown by opponentText
 
-    bool soundEnabled;                         ///< Flag to enable/disable sound effects
+    // Audio system (effects are submitted from the simulation thread and mixed on SFML's streaming thread)
+    SoundMixer mixer;                          ///< Mixes every sound effect voice into one stream
+    MixerStream mixerOutput;                   ///< Plays the mixer through a single OpenAL source
+
+    AudioCueScheduler audioCues;               ///< Delayed sound effects (e.g. level up after line clear)
+    bool soundsAttached;                       ///< Whether the mixer has the effects' samples yet
+
+    MusicStream music;                         ///< Background music, synthesised on SFML's streaming thread
+    bool musicEnabled;                         ///< Whether music plays while sound is on
 
-    // Random number generation
-    std::mt19937 rng;                          ///< Random number generator
-    std::uniform_int_distribution<int> pieceDist; ///< Distribution for selecting random pieces
+    bool soundEnabled;                         ///< Flag to enable/disable sound effects
 
 public:
     /**
      * @brief Constructor - initializes the game
+     *
+     * @param options Seed, replay recording and playback settings
      */
-    Tetris();
+    explicit Tetris(const GameOptions& options);
 
     /**
      * @brief Main game loop
      *
-     * Runs the complete game loop handling input, updates, and rendering
-     * until the window is closed.
+     * Starts the simulation and render threads, handles window events on
+     * the calling thread until the window is closed, stops and joins the
+     * threads, then saves the replay and frame timings if requested.
      */
     void run();
 
 private:
     /**
-     * @brief Load all sound effect files
+     * @brief Give the mixer each effect's samples once the loader has finished and start it (simulation thread)
      *
-     * Attempts to load sound files from multiple possible locations.
-     * Sets soundEnabled flag based on success of loading sounds.
+     * Until then the mixer isn't playing and effects are silent.
      */
-    void loadSounds();
+    void attachSounds();
 
     /**
-     * @brief Generate simple sound effects programmatically
+     * @brief Play a sound effect if audio is enabled
+     *
+     * @param effect The effect to play
      *
-     * Creates basic sound effects if audio files cannot be loaded.
-     * This ensures the game has some audio feedback even without external files.
+     * Helper function to play sounds only when audio is enabled and the
+     * sounds are attached.
      */
-    void generateSounds();
+    void playSound(SoundEffect effect);
 
     /**
-     * @brief Play a sound effect if audio is enabled
+     * @brief Play a sound effect after a delay if audio is enabled
      *
-     * @param sound The sound object to play
+     * @param effect The effect to play
+     * @param delay Time to wait before starting the sound
      *
-     * Helper function to play sounds only when audio is enabled.
+     * Queues the sound on the cue scheduler instead of blocking the game loop.
+     */
+    void playSoundAfter(SoundEffect effect, sf::Time delay);
+
+    /**
+     * @brief Start or pause the music to match the sound setting (simulation thread)
+     */
+    void updateMusicPlayback();
+
+    /**
+     * @brief Push the level and stack height that drive the music's tempo and intensity
      */
-    void playSound(sf::Sound& sound);
+    void updateMusicState();
 
     /**
      * @brief Initialize all UI text elements
      *
      * Sets up fonts, colors, positions, and sizes for all text displays
-     * including score, level, and game over messages.
+     * including score, level, and game over messages. The static controls
+     * panel and the board border are built here once and reused every frame.
      */
     void setupText();
 
     /**
-     * @brief Spawn a new random piece at the top of the board
+     * @brief Refresh HUD text that is out of date
      *
-     * Selects a random piece type, positions it at the spawn location,
-     * and checks for game over condition if the spawn position is blocked.
+     * @param snapshot State being drawn
+     *
+     * Compares score, level and sound state with the values last shown and
+     * only calls setString (which re-lays-out glyphs) for the ones that changed.
+     */
+    void updateHud(const GameSnapshot& snapshot);
+
+    /**
+     * @brief Refresh the frame stats overlay from the profiler
+     *
+     * Only re-lays-out the text every PROFILER_REFRESH_FRAMES frames so the
+     * overlay stays readable and costs next to nothing to keep up.
      */
-    void spawnNewPiece();
+    void updateProfilerText();
 
     /**
-     * @brief Check if a piece can be placed at a specific position
+     * @brief Play the sound effects for a set of engine events
      *
-     * @param x X coordinate to check
-     * @param y Y coordinate to check
-     * @param piece The piece shape to check
-     * @return true if position is valid (no collisions), false otherwise
+     * @param events Bitwise OR of EngineEvent flags raised by the engine
+     */
+    void playEventSounds(unsigned events);
+
+    /**
+     * @brief Apply a player action to the engine and record it
      *
-     * Validates that the piece doesn't collide with board boundaries or existing blocks.
+     * @param action The action to apply
+     *
+     * Player actions are ignored while a replay is playing back.
+     */
+    void applyAction(Action action);
+
+    /**
+     * @brief Sample the gameplay keys and feed changes to the input controller
+     *
+     * Called about once a millisecond, so a press takes effect right away,
+     * between ticks, and is recorded on the tick it happened during. Keys
+     * read as released while the window doesn't have focus.
+     */
+    void sampleKeys();
+
+    /**
+     * @brief Handle the requests the main thread posted since the last step
+     */
+    void handleRequests();
+
+    /**
+     * @brief Publish the engine state to the render thread if it may have changed
      */
-    bool isValidPosition(int x, int y, const std::vector<std::vector<int>>& piece);
+    void publishSnapshot();
 
     /**
-     * @brief Place the current piece permanently on the board
+     * @brief Apply the commands the input controller produced
      *
-     * Transfers the current piece from its temporary state to permanent
-     * positions on the game board grid.
+     * Commands that go as far as possible are resolved with the engine's
+     * travel distance and applied as that many single steps, so replays
+     * record them like any other input.
      */
-    void placePiece();
+    void applyInputCommands();
 
     /**
-     * @brief Check for and clear any complete horizontal lines
+     * @brief Hold the keyboard's gameplay keys in the button byte for the next versus tick
      *
-     * Scans the board for completely filled rows, removes them,
-     * adds new empty rows at the top, and updates score and level.
-     * Also plays appropriate sound effects for line clearing and level up.
+     * A key pressed and released between two ticks still counts as held for one.
      */
-    void clearLines();
+    void sampleVersusKeys();
 
     /**
-     * @brief Rotate a piece 90 degrees clockwise
+     * @brief Run one versus tick if both players' buttons for it have arrived
      *
-     * @param piece The piece to rotate
-     * @return The rotated piece as a new 4x4 grid
+     * @return false if the match has to wait for the opponent
      *
-     * Uses matrix rotation formula to transform the piece shape.
+     * Sends this player's buttons inputDelay ticks ahead and every
+     * CHECK_INTERVAL ticks compares the match hash with the opponent's.
      */
-    std::vector<std::vector<int>> rotatePiece(const std::vector<std::vector<int>>& piece);
+    bool advanceVersus();
 
     /**
-     * @brief Handle all keyboard input and window events
+     * @brief Let the AI play one simulation tick in demo mode
      *
-     * Processes player input for piece movement, rotation, dropping,
-     * game restart, and sound toggle. Also handles window close events.
+     * Every DEMO_TICKS_PER_ACTION ticks, searches from the piece's current
+     * position and applies the first action of the best path (a hard drop
+     * once only soft drops remain). Restarts after game over.
      */
-    void handleInput();
+    void runDemoTick();
 
     /**
-     * @brief Update game state each frame
+     * @brief Handle one window event (main thread)
      *
-     * Handles automatic piece dropping based on timing, piece placement
-     * when pieces can't fall further, line clearing, and spawning new pieces.
+     * @param event Event to handle
+     * @return false once the window should close
+     *
+     * Tracks focus for key sampling and posts the sound, demo and overlay
+     * toggles to the threads that own them. Gameplay keys are sampled by the
+     * simulation thread instead.
+     */
+    bool handleInput(const sf::Event& event);
+
+    /**
+     * @brief Simulation thread body: update() about once a millisecond until stopped
+     */
+    void simulationLoop();
+
+    /**
+     * @brief Advance the game to the current time (simulation thread)
+     *
+     * Samples the keys, runs the engine in fixed ticks for the real time
+     * elapsed since the last step (several ticks if the thread was held up),
+     * advancing the input controller's auto-repeat with every tick, plays
+     * the sound effects for the events raised and publishes a snapshot.
+     * In versus mode the ticks run through the match instead and pause
+     * while the opponent's buttons are late.
      */
     void update();
 
     /**
-     * @brief Render all game graphics to the screen
+     * @brief Render thread body: render() until stopped
+     */
+    void renderLoop();
+
+    /**
+     * @brief Draw the latest snapshot to the screen (render thread)
      *
-     * Draws the game board, current piece, UI elements, and game over screen.
-     * Handles all visual aspects of the game display.
+     * Draws the game board, current piece, UI elements, and game over screen,
+     * then presents the frame when the frame pacer says it is due. With
+     * on-change pacing, first waits until there is something new to show.
      */
     void render();
 };
\ No newline at end of file
@@ -0,0 +1,320 @@
+#include "TetrisAI.h"
+#include <cstring>
+#include <algorithm>
+
+/**
+ * Constructor - Store weights; search buffers are stamped, so they start dirty
+ */
+TetrisAI::TetrisAI(const HeuristicWeights& weights, TranspositionTable* sharedTable) :
+    weights(weights),
+    lastPlacementCount(0),
+    searchStamp(0),
+    table(sharedTable),
+    hasDeadline(false),
+    aborted(false)
+{
+    std::memset(visitedStamp, 0, sizeof(visitedStamp));
+}
+
+/**
+ * Flatten a piece state into a search buffer index
+ */
+int TetrisAI::stateIndex(const ActivePiece& piece) {
+    return (piece.rotation * Y_RANGE + (piece.y + Y_OFFSET)) * X_RANGE + (piece.x + X_OFFSET);
+}
+
+/**
+ * Rebuild a piece state from a search buffer index
+ */
+ActivePiece TetrisAI::stateFromIndex(int index, int type) {
+    ActivePiece piece;
+    piece.type = type;
+    piece.x = index % X_RANGE - X_OFFSET;
+    index /= X_RANGE;
+    piece.y = index % Y_RANGE - Y_OFFSET;
+    piece.rotation = index / Y_RANGE;
+    return piece;
+}
+
+/**
+ * Breadth-first search over every reachable state, scoring the resting ones
+ */
+AIMove TetrisAI::findBestMove(const TetrisEngine& engine, const SearchLimits& limits) {
+    AIMove best;
+    lastPlacementCount = 0;
+    lastStats = SearchStats();
+    if (engine.isGameOver()) return best;
+
+    hasDeadline = limits.timeBudgetUs > 0;
+    deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(limits.timeBudgetUs);
+    aborted = false;
+    rootCandidates.clear();
+
+    const ActivePiece start = engine.getCurrentPiece();
+    const uint16_t* boardRows = engine.getRows();
+    static const Action MOVES[] = { Action::MoveLeft, Action::MoveRight, Action::SoftDrop, Action::Rotate };
+
+    searchStamp++;
+    int head = 0;
+    int tail = 0;
+    int startIndex = stateIndex(start);
+    visitedStamp[startIndex] = searchStamp;
+    parent[startIndex] = -1;
+    queue[tail++] = static_cast<int16_t>(startIndex);
+
+    int bestIndex = -1;
+    while (head < tail) {
+        int index = queue[head++];
+        ActivePiece piece = stateFromIndex(index, start.type);
+
+        // Expand neighbours with the engine's own collision test
+        for (Action move : MOVES) {
+            ActivePiece next = piece;
+            switch (move) {
+            case Action::MoveLeft:  next.x--; break;
+            case Action::MoveRight: next.x++; break;
+            case Action::SoftDrop:  next.y++; break;
+            default:                next.rotation = (next.rotation + 1) % PieceTable::ROTATION_COUNT; break;
+            }
+
+            if (next.y >= TetrisEngine::BOARD_HEIGHT || !engine.isValidPosition(next)) continue;
+
+            int nextIndex = stateIndex(next);
+            if (visitedStamp[nextIndex] == searchStamp) continue;
+
+            visitedStamp[nextIndex] = searchStamp;
+            parent[nextIndex] = static_cast<int16_t>(index);
+            parentAction[nextIndex] = move;
+            queue[tail++] = static_cast<int16_t>(nextIndex);
+        }
+
+        // A state that cannot move down is a resting placement
+        ActivePiece below = piece;
+        below.y++;
+        if (engine.isValidPosition(below)) continue;
+
+        uint16_t rows[TetrisEngine::BOARD_HEIGHT];
+        std::memcpy(rows, boardRows, sizeof(rows));
+        int lines = placeAndClear(rows, piece);
+        candidateStates[candidates.add(rows, lines)] = static_cast<int16_t>(index);
+        lastPlacementCount++;
+
+        if (limits.maxDepth > 1) {
+            RootCandidate candidate;
+            candidate.state = static_cast<int16_t>(index);
+            candidate.lines = lines;
+            candidate.hash = Zobrist::rehashRows(engine.getBoardHash(), boardRows, rows);
+            std::memcpy(candidate.rows, rows, sizeof(rows));
+            rootCandidates.push_back(candidate);
+        }
+
+        if (candidates.isFull()) {
+            scoreCandidates(bestIndex, best.score);
+        }
+    }
+    scoreCandidates(bestIndex, best.score);
+
+    if (bestIndex < 0) return best;
+    lastStats.depth = 1;
+
+    if (limits.maxDepth > 1) {
+        deepen(engine.getNextType(), limits, bestIndex, best.score);
+    }
+
+    // Walk the parent links back to the start to recover the path
+    best.found = true;
+    best.target = stateFromIndex(bestIndex, start.type);
+    for (int index = bestIndex; parent[index] >= 0; index = parent[index]) {
+        best.path.push_back(parentAction[index]);
+    }
+    std::reverse(best.path.begin(), best.path.end());
+    return best;
+}
+
+/**
+ * Evaluate the pending batch and fold it into the running best
+ */
+void TetrisAI::scoreCandidates(int& bestIndex, float& bestScore) {
+    if (candidates.count == 0) return;
+
+    evaluator.evaluate(candidates, weights, candidateFeatures);
+    for (int lane = 0; lane < candidates.count; lane++) {
+        if (bestIndex < 0 || candidateFeatures.score[lane] > bestScore) {
+            bestIndex = candidateStates[lane];
+            bestScore = candidateFeatures.score[lane];
+        }
+    }
+    candidates.clear();
+}
+
+/**
+ * Iterative deepening over the root candidates
+ */
+void TetrisAI::deepen(int nextType, const SearchLimits& limits, int& bestIndex, float& bestScore) {
+    if (!table) {
+        ownTable.reset(new TranspositionTable());
+        table = ownTable.get();
+    }
+
+    int maxDepth = std::min(limits.maxDepth, Zobrist::MAX_DEPTH);
+    for (int depth = 2; depth <= maxDepth; depth++) {
+        int depthBest = -1;
+        float depthScore = 0;
+
+        for (const RootCandidate& candidate : rootCandidates) {
+            float value = weights.linesCleared * candidate.lines +
+                          placementValue(candidate.rows, candidate.hash, nextType, depth - 1);
+            if (aborted) return;  // Keep the result of the last completed depth
+
+            if (depthBest < 0 || value > depthScore) {
+                depthBest = candidate.state;
+                depthScore = value;
+            }
+        }
+
+        bestIndex = depthBest;
+        bestScore = depthScore;
+        lastStats.depth = depth;
+    }
+}
+
+/**
+ * Max node: best placement of a known piece, cached by board, piece and depth
+ */
+float TetrisAI::placementValue(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], uint64_t hash, int type, int depth) {
+    if (outOfTime()) return 0;
+
+    uint64_t key = hash ^ Zobrist::nextKey(type) ^ Zobrist::depthKey(depth);
+    float cached;
+    if (table->probe(key, cached)) {
+        lastStats.tableHits++;
+        return cached;
+    }
+    lastStats.nodes++;
+
+    ActivePiece drops[MAX_DROPS];
+    int dropCount = dropPlacements(rows, type, drops);
+    float best = TOP_OUT_SCORE;
+
+    if (depth == 1) {
+        // Last level: score every resulting board in one batch
+        leafBatch.clear();
+        for (int i = 0; i < dropCount; i++) {
+            uint16_t child[TetrisEngine::BOARD_HEIGHT];
+            std::memcpy(child, rows, sizeof(child));
+            int lines = placeAndClear(child, drops[i]);
+            leafBatch.add(child, lines);
+        }
+        evaluator.evaluate(leafBatch, weights, leafFeatures);
+        for (int lane = 0; lane < leafBatch.count; lane++) {
+            best = std::max(best, leafFeatures.score[lane]);
+        }
+    }
+    else {
+        for (int i = 0; i < dropCount; i++) {
+            uint16_t child[TetrisEngine::BOARD_HEIGHT];
+            std::memcpy(child, rows, sizeof(child));
+            int lines = placeAndClear(child, drops[i]);
+            uint64_t childHash = Zobrist::rehashRows(hash, rows, child);
+
+            float value = weights.linesCleared * lines + chanceValue(child, childHash, depth - 1);
+            if (aborted) return 0;
+            best = std::max(best, value);
+        }
+    }
+
+    table->store(key, depth, best);
+    return best;
+}
+
+/**
+ * Chance node: every piece type is equally likely
+ */
+float TetrisAI::chanceValue(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], uint64_t hash, int depth) {
+    float sum = 0;
+    for (int type = 0; type < PieceTable::PIECE_COUNT; type++) {
+        sum += placementValue(rows, hash, type, depth);
+        if (aborted) return 0;
+    }
+    return sum / PieceTable::PIECE_COUNT;
+}
+
+/**
+ * Hard drop the piece from every distinct rotation and column
+ */
+int TetrisAI::dropPlacements(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], int type, ActivePiece out[MAX_DROPS]) {
+    int count = 0;
+    uint16_t seenShapes[PieceTable::ROTATION_COUNT];
+
+    for (int rotation = 0; rotation < PieceTable::ROTATION_COUNT; rotation++) {
+        const PieceShape& shape = PieceTable::shape(type, rotation);
+
+        // Shift the cells to the grid's top-left corner; rotations of O, I, S and Z
+        // that only move the shape inside the grid give the same placements
+        seenShapes[rotation] = static_cast<uint16_t>(shape.mask >> (shape.minY * 4 + shape.minX));
+        if (std::find(seenShapes, seenShapes + rotation, seenShapes[rotation]) != seenShapes + rotation) continue;
+
+        for (int x = -shape.minX; x + shape.maxX < TetrisEngine::BOARD_WIDTH; x++) {
+            ActivePiece piece = { type, rotation, x, 0 };
+            if (!TetrisEngine::isValidPosition(rows, piece)) continue;
+
+            ActivePiece below = piece;
+            below.y++;
+            while (TetrisEngine::isValidPosition(rows, below)) {
+                piece = below;
+                below.y++;
+            }
+            out[count++] = piece;
+        }
+    }
+    return count;
+}
+
+/**
+ * Compare against the deadline
+ */
+bool TetrisAI::outOfTime() {
+    if (!aborted && hasDeadline && std::chrono::steady_clock::now() >= deadline) {
+        aborted = true;
+    }
+    return aborted;
+}
+
+/**
+ * Execute a move, finishing with a hard drop and locking the piece
+ */
+void TetrisAI::applyMove(TetrisEngine& engine, const AIMove& move) {
+    // Trailing soft drops are replaced by a single hard drop
+    size_t end = move.path.size();
+    while (end > 0 && move.path[end - 1] == Action::SoftDrop) end--;
+
+    for (size_t i = 0; i < end; i++) {
+        engine.step(move.path[i]);
+    }
+    engine.step(Action::HardDrop);
+    engine.gravityStep();
+}
+
+/**
+ * OR the piece into the rows and squeeze out full rows
+ */
+int TetrisAI::placeAndClear(uint16_t rows[TetrisEngine::BOARD_HEIGHT], const ActivePiece& piece) {
+    const PieceShape& shape = PieceTable::shape(piece.type, piece.rotation);
+    for (int py = shape.minY; py <= shape.maxY; py++) {
+        int boardY = piece.y + py;
+        if (boardY < 0) continue;
+        rows[boardY] |= piece.x >= 0 ? shape.rows[py] << piece.x : shape.rows[py] >> -piece.x;
+    }
+
+    int write = TetrisEngine::BOARD_HEIGHT - 1;
+    for (int read = TetrisEngine::BOARD_HEIGHT - 1; read >= 0; read--) {
+        if (rows[read] != TetrisEngine::FULL_ROW) {
+            rows[write--] = rows[read];
+        }
+    }
+    int cleared = write + 1;
+    for (; write >= 0; write--) {
+        rows[write] = 0;
+    }
+    return cleared;
+}
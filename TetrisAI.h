@@ -0,0 +1,207 @@
+#pragma once
+
+#include "TetrisEngine.h"
+#include "BatchEvaluator.h"
+#include "TranspositionTable.h"
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @brief A chosen placement and how to get there
+ */
+struct AIMove {
+    bool found = false;                         ///< False if the piece has no legal placement
+    ActivePiece target = {};                    ///< Final resting position of the piece
+    std::vector<Action> path;                   ///< Actions leading from the current position to target
+    float score = 0;                            ///< Heuristic score of the resulting board
+};
+
+/**
+ * @brief How far and for how long a search may look ahead
+ */
+struct SearchLimits {
+    int maxDepth = 1;                           ///< Pieces to search (1 = current only, 2 = + next, more = + unknown pieces)
+    int timeBudgetUs = 0;                       ///< Stop deepening after this many microseconds (0 = no limit)
+};
+
+/**
+ * @brief What the last search managed to do
+ */
+struct SearchStats {
+    int depth = 0;                              ///< Deepest fully completed depth
+    long long nodes = 0;                        ///< Lookahead nodes expanded
+    long long tableHits = 0;                    ///< Lookahead nodes answered by the transposition table
+};
+
+/**
+ * @brief Placement search that can play the game by itself
+ *
+ * Enumerates every final placement the current piece can reach by
+ * breadth-first search over (x, y, rotation), moving left, right, down and
+ * rotating with the engine's own collision test, so tucks and spins under
+ * overhangs are found as long as the rules allow them. Each resting state is
+ * placed on a copy of the row bitmasks and its lines cleared; the resulting
+ * boards are collected into a BoardBatch and scored together by the
+ * BatchEvaluator.
+ *
+ * With a depth above 1 the search looks further ahead by iterative
+ * deepening: the next piece is known from the engine's preview, and every
+ * piece after that is averaged over all seven types (expectimax). Deeper
+ * pieces are dropped straight down from each rotation and column rather
+ * than searched for tucks. Lookahead nodes are cached by Zobrist hash of
+ * board, piece and remaining depth in a TranspositionTable, which catches
+ * the same board reached through different placement orders and the
+ * subtrees the previous move already explored. Without a time budget the
+ * result is fully deterministic.
+ *
+ * Search buffers are members, so one instance should be used per thread;
+ * the transposition table may be shared between instances on any threads,
+ * as long as they all use the same weights.
+ */
+class TetrisAI {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param weights Heuristic weights
+     * @param sharedTable Transposition table to use for lookahead; if null, one is
+     *                    allocated the first time a search looks ahead
+     */
+    explicit TetrisAI(const HeuristicWeights& weights = HeuristicWeights(), TranspositionTable* sharedTable = nullptr);
+
+    /**
+     * @brief Find the best placement for the engine's current piece
+     *
+     * @param engine Engine whose board and falling piece are searched
+     * @param limits Lookahead depth and time budget
+     * @return The best move of the deepest completed depth; the path starts
+     *         from the piece's current position
+     */
+    AIMove findBestMove(const TetrisEngine& engine, const SearchLimits& limits = SearchLimits());
+
+    /**
+     * @brief Play a move on the engine and lock the piece immediately
+     *
+     * Applies the path, replacing trailing soft drops with a hard drop, then
+     * calls gravityStep so the piece locks without waiting for gravity.
+     * Only valid when no ticks run between the search and this call.
+     */
+    static void applyMove(TetrisEngine& engine, const AIMove& move);
+
+    /**
+     * @brief Number of resting placements scored by the last search
+     */
+    int getLastPlacementCount() const { return lastPlacementCount; }
+
+    /**
+     * @brief Depth, node and cache statistics of the last search
+     */
+    const SearchStats& getLastStats() const { return lastStats; }
+
+    const HeuristicWeights& getWeights() const { return weights; }
+    void setWeights(const HeuristicWeights& newWeights) { weights = newWeights; }
+
+    /**
+     * @brief Lock a piece into a copy of the board rows and clear full lines
+     *
+     * @param rows Row bitmasks, modified in place
+     * @param piece Piece to lock
+     * @return Number of lines cleared
+     */
+    static int placeAndClear(uint16_t rows[TetrisEngine::BOARD_HEIGHT], const ActivePiece& piece);
+
+private:
+    // Search space: x in [-X_OFFSET, BOARD_WIDTH), y in [-Y_OFFSET, BOARD_HEIGHT), 4 rotations
+    static const int X_OFFSET = 3;
+    static const int Y_OFFSET = 3;
+    static const int X_RANGE = TetrisEngine::BOARD_WIDTH + X_OFFSET;
+    static const int Y_RANGE = TetrisEngine::BOARD_HEIGHT + Y_OFFSET;
+    static const int STATE_COUNT = X_RANGE * Y_RANGE * PieceTable::ROTATION_COUNT;
+    static const int MAX_DROPS = PieceTable::ROTATION_COUNT * TetrisEngine::BOARD_WIDTH;
+
+    static_assert(Y_OFFSET >= Zobrist::POSITION_OFFSET,
+                  "The search must cover every height the engine lets a falling piece reach");
+    static constexpr float TOP_OUT_SCORE = -1.0e4f;  ///< Value of a board the piece cannot spawn on
+
+    /**
+     * @brief A resting placement of the current piece, kept for lookahead
+     */
+    struct RootCandidate {
+        int16_t state;                          ///< Search state index
+        int lines;                              ///< Lines the placement cleared
+        uint64_t hash;                          ///< Zobrist hash of the resulting board
+        uint16_t rows[TetrisEngine::BOARD_HEIGHT];  ///< Resulting board
+    };
+
+    HeuristicWeights weights;                   ///< Heuristic weights
+    int lastPlacementCount;                     ///< Resting states scored by the last search
+    SearchStats lastStats;                      ///< Statistics of the last search
+
+    // BFS buffers, reused across searches
+    int16_t parent[STATE_COUNT];                ///< State we came from (-1 = root)
+    Action parentAction[STATE_COUNT];           ///< Action taken from parent
+    uint32_t visitedStamp[STATE_COUNT];         ///< Equals searchStamp if visited in the current search
+    uint32_t searchStamp;                       ///< Incremented per search so buffers never need clearing
+    int16_t queue[STATE_COUNT];                 ///< BFS frontier
+
+    // Candidate scoring
+    BatchEvaluator evaluator;                   ///< SIMD feature evaluator
+    BoardBatch candidates;                      ///< Resting boards waiting to be scored
+    FeatureBatch candidateFeatures;             ///< Scores of the last evaluated batch
+    int16_t candidateStates[BoardBatch::CAPACITY];  ///< Search state of each candidate lane
+
+    // Lookahead
+    TranspositionTable* table;                  ///< Cache of lookahead values (shared or owned)
+    std::unique_ptr<TranspositionTable> ownTable;   ///< Allocated on first use when no table is shared
+    std::vector<RootCandidate> rootCandidates;  ///< Placements of the current piece
+    BoardBatch leafBatch;                       ///< Boards at the last lookahead level
+    FeatureBatch leafFeatures;                  ///< Scores of leafBatch
+    std::chrono::steady_clock::time_point deadline;  ///< When the time budget runs out
+    bool hasDeadline;                           ///< Whether a time budget applies
+    bool aborted;                               ///< Set once the deadline passes mid-depth
+
+    /**
+     * @brief Score the pending candidates and keep the best one
+     *
+     * Lanes are compared in the order they were found, so ties resolve the
+     * same way as scoring each placement as soon as it is found.
+     */
+    void scoreCandidates(int& bestIndex, float& bestScore);
+
+    /**
+     * @brief Re-rank the root candidates with deeper and deeper lookahead
+     *
+     * Updates the best candidate after every completed depth and stops at
+     * limits.maxDepth or when the time budget runs out.
+     */
+    void deepen(int nextType, const SearchLimits& limits, int& bestIndex, float& bestScore);
+
+    /**
+     * @brief Best value of placing a known piece, then depth - 1 unknown pieces
+     */
+    float placementValue(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], uint64_t hash, int type, int depth);
+
+    /**
+     * @brief Value of a board averaged over every type the next piece could be
+     */
+    float chanceValue(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], uint64_t hash, int depth);
+
+    /**
+     * @brief Resting positions of a piece dropped straight down from every rotation and column
+     *
+     * Rotations that only translate the shape are skipped.
+     *
+     * @return Number of placements written to out
+     */
+    static int dropPlacements(const uint16_t rows[TetrisEngine::BOARD_HEIGHT], int type, ActivePiece out[MAX_DROPS]);
+
+    /**
+     * @brief Check the time budget, latching aborted once it has run out
+     */
+    bool outOfTime();
+
+    static int stateIndex(const ActivePiece& piece);
+    static ActivePiece stateFromIndex(int index, int type);
+};
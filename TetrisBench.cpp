@@ -0,0 +1,809 @@
+/**
+ * @file TetrisBench.cpp
+ * @brief Micro-benchmarks for the engine, the search, sound synthesis and mixing, and the renderer
+ *
+ * Times the core game operations on representative boards and reports
+ * ns/op, heap allocations/op and throughput. Results can be written as JSON
+ * so two builds can be diffed for regressions. With --check it instead
+ * verifies a few engine edge cases and reports pass or fail.
+ *
+ * Command line options:
+ *   --json <file>         Also write the results as JSON
+ *   --filter <text>       Only run benchmarks whose name contains the text
+ *   --min-time <ms>       Target time per sample (default: 50)
+ *   --no-render           Skip the benchmarks that need a graphics context
+ *   --wav <file>          Also write a few seconds of mixer output to a WAV file (no audio device needed)
+ *   --check               Run the engine correctness checks instead of the benchmarks
+ */
+
+#include "TetrisEngine.h"
+#include "TetrisAI.h"
+#include "BatchEvaluator.h"
+#include "BoardRenderer.h"
+#include "ToneSynth.h"
+#include "SoundMixer.h"
+#include "WavOutput.h"
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <atomic>
+#include <bitset>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+
+// ---------------------------------------------------------------------------
+// Allocation counting: every global operator new goes through here
+// ---------------------------------------------------------------------------
+
+static std::atomic<long long> allocationCount(0);
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    std::size_t align = static_cast<std::size_t>(alignment);
+#ifdef _MSC_VER
+    if (void* p = _aligned_malloc(size ? size : 1, align)) return p;
+#else
+    if (void* p = std::aligned_alloc(align, (size + align - 1) / align * align)) return p;
+#endif
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+#ifdef _MSC_VER
+void operator delete(void* p, std::align_val_t) noexcept { _aligned_free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { _aligned_free(p); }
+#else
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { std::free(p); }
+#endif
+
+/**
+ * @brief Reaches into the engine to time its private steps in isolation
+ *
+ * Declared a friend of TetrisEngine. Only the benchmark uses it.
+ */
+class EngineBenchmark {
+public:
+    /**
+     * @brief Board state touched by placePiece and clearLines
+     */
+    struct Snapshot {
+        uint16_t rows[TetrisEngine::BOARD_HEIGHT];
+        uint8_t colorPlane[TetrisEngine::BOARD_HEIGHT][TetrisEngine::BOARD_WIDTH];
+        uint64_t boardHash;
+        ActivePiece current;
+        int score;
+        int level;
+        int linesCleared;
+        int dropIntervalTicks;
+    };
+
+    static void setBoard(TetrisEngine& engine, const uint16_t rows[TetrisEngine::BOARD_HEIGHT]) {
+        std::memcpy(engine.rows, rows, sizeof(engine.rows));
+        for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; y++) {
+            for (int x = 0; x < TetrisEngine::BOARD_WIDTH; x++) {
+                engine.colorPlane[y][x] = (rows[y] >> x) & 1 ? 1 : 0;
+            }
+        }
+        engine.boardHash = Zobrist::hashRows(rows);
+        engine.gameOver = false;
+    }
+
+    static void setPiece(TetrisEngine& engine, const ActivePiece& piece) { engine.current = piece; }
+
+    static Snapshot save(const TetrisEngine& engine) {
+        Snapshot snapshot;
+        std::memcpy(snapshot.rows, engine.rows, sizeof(snapshot.rows));
+        std::memcpy(snapshot.colorPlane, engine.colorPlane, sizeof(snapshot.colorPlane));
+        snapshot.boardHash = engine.boardHash;
+        snapshot.current = engine.current;
+        snapshot.score = engine.score;
+        snapshot.level = engine.level;
+        snapshot.linesCleared = engine.linesCleared;
+        snapshot.dropIntervalTicks = engine.dropIntervalTicks;
+        return snapshot;
+    }
+
+    static void restore(TetrisEngine& engine, const Snapshot& snapshot) {
+        std::memcpy(engine.rows, snapshot.rows, sizeof(snapshot.rows));
+        std::memcpy(engine.colorPlane, snapshot.colorPlane, sizeof(snapshot.colorPlane));
+        engine.boardHash = snapshot.boardHash;
+        engine.current = snapshot.current;
+        engine.score = snapshot.score;
+        engine.level = snapshot.level;
+        engine.linesCleared = snapshot.linesCleared;
+        engine.dropIntervalTicks = snapshot.dropIntervalTicks;
+    }
+
+    static void placePiece(TetrisEngine& engine) { engine.placePiece(); }
+    static void clearLines(TetrisEngine& engine) { engine.clearLines(); }
+    static void spawnNewPiece(TetrisEngine& engine) { engine.spawnNewPiece(); }
+};
+
+namespace {
+    /**
+     * One benchmark's numbers
+     */
+    struct BenchResult {
+        std::string name;
+        double nsPerOp;
+        double allocationsPerOp;
+        double opsPerSecond;
+        long long iterations;
+    };
+
+    /**
+     * Run options and collected results
+     */
+    struct BenchContext {
+        std::string filter;
+        double minSampleSeconds = 0.05;
+        std::vector<BenchResult> results;
+    };
+
+    const int SAMPLES = 5;                      // Samples per benchmark; the median is reported
+
+    volatile long long benchSink;               // Keeps results observable so work is not optimised away
+
+    /**
+     * Build a board from text rows ('#' = filled), listed top to bottom and
+     * stacked on the floor
+     */
+    std::vector<uint16_t> boardFromText(const std::vector<const char*>& lines) {
+        std::vector<uint16_t> rows(TetrisEngine::BOARD_HEIGHT, 0);
+        int y = TetrisEngine::BOARD_HEIGHT - static_cast<int>(lines.size());
+        for (const char* line : lines) {
+            for (int x = 0; x < TetrisEngine::BOARD_WIDTH; x++) {
+                if (line[x] == '#') rows[y] |= static_cast<uint16_t>(1u << x);
+            }
+            y++;
+        }
+        return rows;
+    }
+
+    /**
+     * Time `op(i)` for `iterations` iterations
+     */
+    template <typename Op>
+    double timeBatch(Op& op, long long iterations) {
+        auto start = std::chrono::steady_clock::now();
+        for (long long i = 0; i < iterations; i++) {
+            op(i);
+        }
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        return elapsed.count();
+    }
+
+    /**
+     * Calibrate, take SAMPLES timed batches and record the median
+     *
+     * @param baselineNs Cost of per-iteration setup included in op, subtracted from the result
+     */
+    template <typename Op>
+    double runBenchmark(BenchContext& context, const std::string& name, Op op, double baselineNs = 0) {
+        if (!context.filter.empty() && name.find(context.filter) == std::string::npos) return 0;
+
+        // Double the batch until one sample takes long enough to time reliably
+        long long iterations = 1;
+        while (timeBatch(op, iterations) < context.minSampleSeconds && iterations < (1LL << 40)) {
+            iterations *= 2;
+        }
+
+        double samples[SAMPLES];
+        long long allocationsBefore = allocationCount.load();
+        for (int sample = 0; sample < SAMPLES; sample++) {
+            samples[sample] = timeBatch(op, iterations) * 1e9 / iterations;
+        }
+        long long allocations = allocationCount.load() - allocationsBefore;
+
+        std::sort(samples, samples + SAMPLES);
+        double nsPerOp = std::max(samples[SAMPLES / 2] - baselineNs, 0.0);
+
+        BenchResult result;
+        result.name = name;
+        result.nsPerOp = nsPerOp;
+        result.allocationsPerOp = static_cast<double>(allocations) / (static_cast<double>(iterations) * SAMPLES);
+        result.opsPerSecond = nsPerOp > 0 ? 1e9 / nsPerOp : 0;
+        result.iterations = iterations;
+        context.results.push_back(result);
+
+        std::cout << std::left << std::setw(34) << name << std::right
+                  << std::setw(12) << std::fixed << std::setprecision(2) << nsPerOp << " ns/op"
+                  << std::setw(10) << std::setprecision(3) << result.allocationsPerOp << " allocs/op"
+                  << std::setw(14) << std::setprecision(0) << result.opsPerSecond << " ops/s" << std::endl;
+        return samples[SAMPLES / 2];
+    }
+
+    /**
+     * Representative boards, from an empty well to one row from topping out
+     */
+    struct NamedBoard {
+        const char* name;
+        std::vector<uint16_t> rows;
+    };
+
+    std::vector<NamedBoard> makeBoards() {
+        return {
+            { "empty", boardFromText({}) },
+            { "midgame", boardFromText({
+                "......#...",
+                "#....###..",
+                "##..####.#",
+                "###.####.#",
+                "####.###.#",
+                "#####.##.#",
+                "##.######.",
+                "#########." }) },
+            { "neartop", boardFromText({
+                "#.........",
+                "##.....#..",
+                "###...###.",
+                "####.####.",
+                "####.#####",
+                "#.##.#####",
+                "####.#.###",
+                "####.#####",
+                "#.##.#####",
+                "####.###.#",
+                "##.#.#####",
+                "####.#####",
+                "####.##.##",
+                "#.##.#####",
+                "####.#####",
+                "###..#####",
+                "#########." }) }
+        };
+    }
+
+    /**
+     * Collision checks over every position of every piece
+     */
+    void benchCollision(BenchContext& context, const std::vector<NamedBoard>& boards) {
+        std::vector<ActivePiece> positions;
+        for (int type = 0; type < PieceTable::PIECE_COUNT; type++) {
+            for (int rotation = 0; rotation < PieceTable::ROTATION_COUNT; rotation++) {
+                for (int y = -2; y < TetrisEngine::BOARD_HEIGHT; y++) {
+                    for (int x = -2; x < TetrisEngine::BOARD_WIDTH; x++) {
+                        positions.push_back({ type, rotation, x, y });
+                    }
+                }
+            }
+        }
+
+        for (const auto& board : boards) {
+            TetrisEngine engine(1);
+            EngineBenchmark::setBoard(engine, board.rows.data());
+            size_t next = 0;
+            long long valid = 0;
+
+            runBenchmark(context, std::string("isValidPosition/") + board.name, [&](long long) {
+                valid += engine.isValidPosition(positions[next]);
+                if (++next == positions.size()) next = 0;
+            });
+            benchSink = valid;
+        }
+    }
+
+    /**
+     * Rotating the falling piece through the public step() API
+     */
+    void benchRotate(BenchContext& context, const std::vector<NamedBoard>& boards) {
+        for (const auto& board : boards) {
+            TetrisEngine engine(1);
+            EngineBenchmark::setBoard(engine, board.rows.data());
+            EngineBenchmark::setPiece(engine, { 2, 0, 3, 0 });  // T piece at the spawn position
+
+            runBenchmark(context, std::string("rotatePiece/") + board.name, [&](long long) {
+                engine.step(Action::Rotate);
+            });
+            benchSink = engine.getCurrentPiece().rotation + static_cast<int>(engine.consumeEvents());
+        }
+    }
+
+    /**
+     * Locking a piece at its landing row, with the board restored every iteration
+     */
+    void benchPlace(BenchContext& context, const std::vector<NamedBoard>& boards) {
+        for (const auto& board : boards) {
+            TetrisEngine engine(1);
+            EngineBenchmark::setBoard(engine, board.rows.data());
+
+            // Drop a T piece from the spawn column onto the stack
+            ActivePiece piece = { 2, 0, 3, 0 };
+            ActivePiece below = { 2, 0, 3, 1 };
+            while (engine.isValidPosition(below)) {
+                piece = below;
+                below.y++;
+            }
+            EngineBenchmark::setPiece(engine, piece);
+            EngineBenchmark::Snapshot snapshot = EngineBenchmark::save(engine);
+
+            double baseline = runBenchmark(context, std::string("restoreBoard/") + board.name, [&](long long) {
+                EngineBenchmark::restore(engine, snapshot);
+            });
+            runBenchmark(context, std::string("placePiece/") + board.name, [&](long long) {
+                EngineBenchmark::restore(engine, snapshot);
+                EngineBenchmark::placePiece(engine);
+            }, baseline);
+            benchSink = static_cast<long long>(engine.getBoardHash());
+        }
+    }
+
+    /**
+     * Clearing 0, 1 and 4 rows under a freshly placed piece
+     */
+    void benchClear(BenchContext& context, const std::vector<NamedBoard>& boards) {
+        struct ClearCase {
+            const char* name;
+            std::vector<uint16_t> rows;
+            ActivePiece piece;                  // Dropped straight down, then locked before timing
+        };
+
+        const ActivePiece verticalI = { 0, 1, 7, 0 };  // Fills column 9
+        std::vector<ClearCase> cases = {
+            { "none", boards[1].rows, { 2, 0, 3, 0 } },
+            { "single", boardFromText({
+                "#.#######.",
+                "##.######.",
+                "###.#####.",
+                "#########." }), verticalI },
+            { "tetris", boardFromText({
+                "###.###...",
+                "#.##.###..",
+                "#########.",
+                "#########.",
+                "#########.",
+                "#########." }), verticalI }
+        };
+
+        for (const auto& clearCase : cases) {
+            TetrisEngine engine(1);
+            EngineBenchmark::setBoard(engine, clearCase.rows.data());
+
+            ActivePiece piece = clearCase.piece;
+            ActivePiece below = piece;
+            below.y++;
+            while (engine.isValidPosition(below)) {
+                piece = below;
+                below.y++;
+            }
+            EngineBenchmark::setPiece(engine, piece);
+            EngineBenchmark::placePiece(engine);
+            EngineBenchmark::Snapshot snapshot = EngineBenchmark::save(engine);
+
+            double baseline = runBenchmark(context, std::string("restoreBoard/clear-") + clearCase.name, [&](long long) {
+                EngineBenchmark::restore(engine, snapshot);
+            });
+            runBenchmark(context, std::string("clearLines/") + clearCase.name, [&](long long) {
+                EngineBenchmark::restore(engine, snapshot);
+                EngineBenchmark::clearLines(engine);
+            }, baseline);
+            benchSink = engine.getLinesCleared();
+        }
+    }
+
+    /**
+     * Drawing the next piece and testing its spawn position
+     */
+    void benchSpawn(BenchContext& context, const std::vector<NamedBoard>& boards) {
+        for (const auto& board : boards) {
+            TetrisEngine engine(1);
+            EngineBenchmark::setBoard(engine, board.rows.data());
+
+            runBenchmark(context, std::string("spawnNewPiece/") + board.name, [&](long long) {
+                EngineBenchmark::spawnNewPiece(engine);
+            });
+            benchSink = engine.getCurrentPiece().type;
+        }
+    }
+
+    /**
+     * Placement search and batch evaluation
+     */
+    void benchSearch(BenchContext& context, const std::vector<NamedBoard>& boards) {
+        TetrisAI ai;
+        for (const auto& board : boards) {
+            TetrisEngine engine(1);
+            EngineBenchmark::setBoard(engine, board.rows.data());
+            EngineBenchmark::setPiece(engine, { 2, 0, 3, 0 });
+
+            runBenchmark(context, std::string("findBestMove/") + board.name, [&](long long) {
+                benchSink = ai.findBestMove(engine).target.x;
+            });
+        }
+
+        // One batch of realistic candidate boards per backend
+        BoardBatch batch;
+        TetrisEngine engine(5);
+        while (!batch.isFull()) {
+            if (engine.isGameOver()) engine.step(Action::Restart);
+            TetrisAI::applyMove(engine, ai.findBestMove(engine));
+            batch.add(engine.getRows(), 0);
+        }
+
+        HeuristicWeights weights;
+        FeatureBatch features;
+        const EvalBackend backends[] = { EvalBackend::Scalar, EvalBackend::SSE2, EvalBackend::AVX2 };
+        for (EvalBackend backend : backends) {
+            if (!BatchEvaluator::isAvailable(backend)) continue;
+
+            BatchEvaluator evaluator(backend);
+            double nsPerBatch = runBenchmark(context, std::string("evaluateBatch64/") + BatchEvaluator::backendName(backend), [&](long long) {
+                evaluator.evaluate(batch, weights, features);
+            });
+            benchSink = static_cast<long long>(features.score[0]);
+
+            std::cout << "    " << nsPerBatch / BoardBatch::CAPACITY << " ns/board" << std::endl;
+        }
+    }
+
+    /**
+     * Procedural sound effect synthesis (the game's longest tone) per backend
+     */
+    void benchSynth(BenchContext& context) {
+        const unsigned SAMPLE_RATE = 44100;
+        const ToneSpec gameOver = { 1.0f, 4000.0f, 2.0f, 1, { 440.0f }, 2.0f, 0.0f };
+        const ToneSpec lineClear = { 0.5f, 4000.0f, 3.0f, 3, { 523.25f, 659.25f, 783.99f }, 0.0f, 0.0f };
+        std::vector<int16_t> samples;
+
+        const SynthBackend backends[] = { SynthBackend::Scalar, SynthBackend::SSE2, SynthBackend::AVX2 };
+        for (SynthBackend backend : backends) {
+            if (!ToneSynth::isAvailable(backend)) continue;
+
+            ToneSynth synth(backend);
+            runBenchmark(context, std::string("synthGameOver/") + ToneSynth::backendName(backend), [&](long long) {
+                synth.render(gameOver, SAMPLE_RATE, samples);
+            });
+            runBenchmark(context, std::string("synthLineClear/") + ToneSynth::backendName(backend), [&](long long) {
+                synth.render(lineClear, SAMPLE_RATE, samples);
+            });
+            benchSink = samples[100];
+        }
+    }
+
+    /**
+     * Mix one 512-sample buffer (the game's default) with about eight voices
+     * sounding, retriggered through the command queue as in the game; with
+     * a path, also render a short scripted sequence through the null WAV output
+     */
+    void benchMixer(BenchContext& context, const std::string& wavPath) {
+        const int BUFFER_FRAMES = 512;
+        const ToneSpec lineClear = { 0.5f, 4000.0f, 3.0f, 3, { 523.25f, 659.25f, 783.99f }, 0.0f, 0.0f };
+        const ToneSpec gameOver = { 1.0f, 4000.0f, 2.0f, 1, { 440.0f }, 2.0f, 0.0f };
+        std::vector<int16_t> lineClearSamples;
+        std::vector<int16_t> gameOverSamples;
+        ToneSynth synth;
+        synth.render(lineClear, SoundMixer::SAMPLE_RATE, lineClearSamples);
+        synth.render(gameOver, SoundMixer::SAMPLE_RATE, gameOverSamples);
+
+        auto setEffects = [&](SoundMixer& mixer) {
+            mixer.setEffect(SoundEffect::LineClear, lineClearSamples.data(), lineClearSamples.size(), 1,
+                            SoundMixer::SAMPLE_RATE, { 8, 0 });
+            mixer.setEffect(SoundEffect::GameOver, gameOverSamples.data(), gameOverSamples.size(), 1,
+                            SoundMixer::SAMPLE_RATE, { 8, 0 });
+        };
+
+        const MixBackend backends[] = { MixBackend::Scalar, MixBackend::SSE2, MixBackend::AVX2 };
+        for (MixBackend backend : backends) {
+            if (!SoundMixer::isAvailable(backend)) continue;
+
+            SoundMixer mixer(SoundMixer::MAX_VOICES, backend);
+            setEffects(mixer);
+            std::vector<int16_t> out(BUFFER_FRAMES);
+            runBenchmark(context, std::string("mix512/") + SoundMixer::backendName(backend), [&](long long i) {
+                // A line clear lasts 43 buffers and a game over 86, so this keeps about 8 voices busy
+                if (i % 16 == 0) {
+                    mixer.play(SoundEffect::LineClear);
+                    mixer.play(SoundEffect::GameOver);
+                }
+                mixer.mix(out.data(), BUFFER_FRAMES);
+            });
+            benchSink = out[100];
+        }
+
+        if (wavPath.empty()) return;
+
+        // Overlapping chords over a falling tone, two seconds apart
+        SoundMixer mixer;
+        setEffects(mixer);
+        WavOutput output(mixer, BUFFER_FRAMES);
+        if (!output.open(wavPath)) {
+            std::cout << "mixer: could not write " << wavPath << std::endl;
+            return;
+        }
+        const int BLOCKS_PER_SECOND = SoundMixer::SAMPLE_RATE / BUFFER_FRAMES;
+        for (int block = 0; block < 5 * BLOCKS_PER_SECOND; block++) {
+            if (block % (2 * BLOCKS_PER_SECOND) == 0) mixer.play(SoundEffect::GameOver);
+            if (block % (BLOCKS_PER_SECOND / 4) == 0) mixer.play(SoundEffect::LineClear);
+            output.pull();
+        }
+        uint32_t frames = output.getFrameCount();
+        if (output.close()) {
+            std::cout << "Wrote " << frames << " mixed samples (" << SoundMixer::backendName(mixer.getBackend())
+                      << ") to " << wavPath << std::endl;
+        }
+    }
+
+    /**
+     * A frame like Tetris::render(), drawn offscreen
+     */
+    void benchRender(BenchContext& context, const std::vector<NamedBoard>& boards) {
+        const unsigned WIDTH = 800;
+        const unsigned HEIGHT = 700;
+        const float BLOCK_SIZE = 30.0f;
+
+        sf::RenderTexture target;
+        if (!target.create(WIDTH, HEIGHT)) {
+            std::cout << "render: could not create a render texture, skipped" << std::endl;
+            return;
+        }
+
+        const std::vector<sf::Color> colors = {
+            sf::Color::Black, sf::Color::Cyan, sf::Color::Yellow, sf::Color::Magenta,
+            sf::Color::Green, sf::Color::Red, sf::Color::Blue, sf::Color(255, 165, 0)
+        };
+
+        sf::Font font;
+        bool hasFont = font.loadFromFile("arial.ttf") || font.loadFromFile("fonts/arial.ttf") ||
+                       font.loadFromFile("/usr/share/fonts/truetype/dejavu/DejaVuSans.ttf");
+        sf::Text scoreText("Score: 123456", font, 24);
+        sf::Text levelText("Level: 7", font, 24);
+        sf::Text soundText("Sound: ON", font, 18);
+
+        sf::RectangleShape border(sf::Vector2f(TetrisEngine::BOARD_WIDTH * BLOCK_SIZE, TetrisEngine::BOARD_HEIGHT * BLOCK_SIZE));
+        border.setFillColor(sf::Color::Transparent);
+        border.setOutlineColor(sf::Color::White);
+        border.setOutlineThickness(2);
+
+        for (const auto& board : boards) {
+            TetrisEngine engine(1);
+            EngineBenchmark::setBoard(engine, board.rows.data());
+            BoardRenderer renderer(BLOCK_SIZE);
+            GameSnapshot snapshot;
+
+            // Move the piece every iteration so the renderer always has quads to rewrite;
+            // the snapshot capture is included because the game takes one per change
+            runBenchmark(context, std::string("boardUpdate/") + board.name, [&](long long i) {
+                EngineBenchmark::setPiece(engine, { 2, static_cast<int>(i & 3), 3, 0 });
+                snapshot.capture(engine, 0);
+                renderer.update(snapshot, colors);
+            });
+
+            runBenchmark(context, std::string("renderFrame/") + board.name, [&](long long i) {
+                EngineBenchmark::setPiece(engine, { 2, static_cast<int>(i & 3), 3, 0 });
+                target.clear(sf::Color::Black);
+                snapshot.capture(engine, 0);
+                renderer.update(snapshot, colors);
+                target.draw(renderer);
+                target.draw(border);
+                if (hasFont) {
+                    target.draw(scoreText);
+                    target.draw(levelText);
+                    target.draw(soundText);
+                }
+                target.display();
+            });
+        }
+    }
+
+    /**
+     * Escape a string for JSON output
+     */
+    std::string jsonString(const std::string& text) {
+        std::string escaped = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') escaped += '\\';
+            escaped += c;
+        }
+        return escaped + "\"";
+    }
+
+    /**
+     * Write the results and build description as JSON
+     */
+    bool writeJson(const std::string& path, const BenchContext& context) {
+        std::ofstream out(path);
+        if (!out) return false;
+
+#ifdef NDEBUG
+        const char* configuration = "release";
+#else
+        const char* configuration = "debug";
+#endif
+#if defined(_MSC_VER)
+        std::string compiler = "msvc " + std::to_string(_MSC_VER);
+#elif defined(__clang__)
+        std::string compiler = std::string("clang ") + __clang_version__;
+#elif defined(__GNUC__)
+        std::string compiler = std::string("gcc ") + __VERSION__;
+#else
+        std::string compiler = "unknown";
+#endif
+
+        out << "{\n";
+        out << "  \"build\": {\n";
+        out << "    \"configuration\": " << jsonString(configuration) << ",\n";
+        out << "    \"compiler\": " << jsonString(compiler) << ",\n";
+        out << "    \"pointerBits\": " << sizeof(void*) * 8 << ",\n";
+        out << "    \"evalBackend\": " << jsonString(BatchEvaluator::backendName(BatchEvaluator::bestBackend())) << "\n";
+        out << "  },\n";
+        out << "  \"benchmarks\": [\n";
+        for (size_t i = 0; i < context.results.size(); i++) {
+            const BenchResult& result = context.results[i];
+            out << "    { \"name\": " << jsonString(result.name)
+                << ", \"nsPerOp\": " << result.nsPerOp
+                << ", \"allocationsPerOp\": " << result.allocationsPerOp
+                << ", \"opsPerSecond\": " << result.opsPerSecond
+                << ", \"iterations\": " << result.iterations << " }"
+                << (i + 1 < context.results.size() ? "," : "") << "\n";
+        }
+        out << "  ]\n";
+        out << "}\n";
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * @brief Whether the falling piece keeps a cell on the board inside the range the hash keys cover
+     */
+    bool pieceOnBoard(const TetrisEngine& engine) {
+        const ActivePiece& piece = engine.getCurrentPiece();
+        const PieceShape& shape = PieceTable::shape(piece.type, piece.rotation);
+        return piece.y >= -Zobrist::POSITION_OFFSET && piece.y + shape.maxY >= 0;
+    }
+
+    /**
+     * @brief Settled blocks on the board
+     */
+    int countBlocks(const TetrisEngine& engine) {
+        int blocks = 0;
+        for (int y = 0; y < TetrisEngine::BOARD_HEIGHT; y++) {
+            blocks += static_cast<int>(std::bitset<TetrisEngine::BOARD_WIDTH>(engine.getRows()[y]).count());
+        }
+        return blocks;
+    }
+
+    /**
+     * Garbage pushed under a piece near the top must top out rather than lift the piece off the board
+     *
+     * A vertical I piece at the spawn point takes four-row batches with the hole
+     * moving every time. After each batch the piece has to keep a cell on the
+     * board inside the range the hash keys and the search index, or the game
+     * has to be over; both are exercised on every state so a sanitizer build
+     * catches out-of-range indexing too.
+     *
+     * Then the piece is lifted one row at a time until only its bottom cell is
+     * on the board and rotated: the rotation must not take it off the board,
+     * so locking it still leaves a block behind.
+     */
+    bool checkGarbageTopOut() {
+        const uint16_t empty[TetrisEngine::BOARD_HEIGHT] = {};
+        TetrisEngine engine(1);
+        EngineBenchmark::setBoard(engine, empty);
+        EngineBenchmark::setPiece(engine, { 0, 1, TetrisEngine::BOARD_WIDTH / 2 - 2, 0 });
+
+        TetrisAI ai;
+        for (int batch = 0; batch < TetrisEngine::BOARD_HEIGHT && !engine.isGameOver(); batch++) {
+            engine.addGarbage(4, batch % TetrisEngine::BOARD_WIDTH);
+            if (engine.isGameOver()) break;
+
+            if (!pieceOnBoard(engine)) {
+                std::cout << "check garbageTopOut: piece lifted off the board (y = " << engine.getCurrentPiece().y << ")" << std::endl;
+                return false;
+            }
+            benchSink = static_cast<long long>(engine.getHash()) + ai.findBestMove(engine).target.x;
+        }
+
+        if (!engine.isGameOver()) {
+            std::cout << "check garbageTopOut: a full stack of garbage did not end the game" << std::endl;
+            return false;
+        }
+
+        TetrisEngine rotated(1);
+        EngineBenchmark::setBoard(rotated, empty);
+        EngineBenchmark::setPiece(rotated, { 0, 1, TetrisEngine::BOARD_WIDTH / 2 - 2, 0 });
+        for (int row = 0; row < TetrisEngine::BOARD_HEIGHT - 1; row++) {
+            rotated.addGarbage(1, row % 2 ? 0 : TetrisEngine::BOARD_WIDTH - 1);
+        }
+        rotated.step(Action::Rotate);
+        if (rotated.isGameOver() || !pieceOnBoard(rotated)) {
+            std::cout << "check garbageTopOut: piece rotated off the board (y = " << rotated.getCurrentPiece().y << ")" << std::endl;
+            return false;
+        }
+
+        int blocksBefore = countBlocks(rotated);
+        rotated.gravityStep();
+        if (countBlocks(rotated) <= blocksBefore) {
+            std::cout << "check garbageTopOut: the piece locked without leaving a block" << std::endl;
+            return false;
+        }
+        std::cout << "check garbageTopOut: ok" << std::endl;
+        return true;
+    }
+
+    void printUsage() {
+        std::cout << "Usage: tetris_bench [--json <file>] [--filter <text>] [--min-time <ms>] [--no-render] [--wav <file>]" << std::endl;
+        std::cout << "       tetris_bench --check" << std::endl;
+    }
+}
+
+/**
+ * @brief Run every benchmark and report the results, or only the checks with --check
+ *
+ * @return 0 on success, 1 on bad arguments, a failed check or if the JSON file could not be written
+ */
+int main(int argc, char* argv[]) {
+    BenchContext context;
+    std::string jsonPath;
+    std::string wavPath;
+    bool render = true;
+    bool check = false;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        }
+        else if (arg == "--filter" && i + 1 < argc) {
+            context.filter = argv[++i];
+        }
+        else if (arg == "--min-time" && i + 1 < argc) {
+            context.minSampleSeconds = std::stoi(argv[++i]) / 1000.0;
+        }
+        else if (arg == "--no-render") {
+            render = false;
+        }
+        else if (arg == "--wav" && i + 1 < argc) {
+            wavPath = argv[++i];
+        }
+        else if (arg == "--check") {
+            check = true;
+        }
+        else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    // Correctness checks run on their own so timing runs never fail on them
+    if (check) {
+        return checkGarbageTopOut() ? 0 : 1;
+    }
+
+    std::vector<NamedBoard> boards = makeBoards();
+
+    benchCollision(context, boards);
+    benchRotate(context, boards);
+    benchPlace(context, boards);
+    benchClear(context, boards);
+    benchSpawn(context, boards);
+    benchSearch(context, boards);
+    benchSynth(context);
+    benchMixer(context, wavPath);
+    if (render) {
+        benchRender(context, boards);
+    }
+
+    if (!jsonPath.empty()) {
+        if (!writeJson(jsonPath, context)) {
+            std::cerr << "Could not write " << jsonPath << std::endl;
+            return 1;
+        }
+        std::cout << "Wrote " << jsonPath << std::endl;
+    }
+    return 0;
+}
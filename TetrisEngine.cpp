@@ -0,0 +1,365 @@
+#include "TetrisEngine.h"
+#include <algorithm>
+#include <bitset>
+#include <cstring>
+
+const int TetrisEngine::MIN_DROP_TICKS;
+
+/**
+ * Constructor - Seed the piece sequence and start a new game
+ */
+TetrisEngine::TetrisEngine(uint32_t seed) :
+    current{ 0, 0, 0, 0 },
+    nextType(0),
+    score(0),
+    level(1),
+    linesCleared(0),
+    piecesPlaced(0),
+    gameOver(false),
+    dropIntervalTicks(INITIAL_DROP_TICKS),
+    dropCounter(0),
+    tickCount(0),
+    events(0),
+    boardHash(0),
+    seed(seed),
+    rng(seed)
+{
+    // The next piece is drawn one ahead, so the sequence of types is the
+    // same as drawing each piece when it spawns
+    nextType = static_cast<int>(rng() % PieceTable::PIECE_COUNT);
+    reset();
+}
+
+/**
+ * Reset all game state and spawn a fresh piece
+ */
+void TetrisEngine::reset() {
+    // Empty board
+    std::memset(rows, 0, sizeof(rows));
+    std::memset(colorPlane, 0, sizeof(colorPlane));
+    boardHash = 0;
+    score = 0;
+    level = 1;
+    linesCleared = 0;
+    piecesPlaced = 0;
+    gameOver = false;
+    dropIntervalTicks = INITIAL_DROP_TICKS;
+    dropCounter = 0;
+    spawnNewPiece();
+}
+
+/**
+ * Apply a single player action to the game state
+ */
+bool TetrisEngine::step(Action action) {
+    // Restart is the only action accepted once the game has ended
+    if (gameOver) {
+        if (action == Action::Restart) {
+            reset();
+            return true;
+        }
+        return false;
+    }
+
+    ActivePiece moved = current;
+
+    switch (action) {
+    case Action::MoveLeft:
+        // Move piece left if possible
+        moved.x--;
+        if (isValidPosition(moved)) {
+            current = moved;
+            events |= EngineEvent::Move;
+            return true;
+        }
+        break;
+
+    case Action::MoveRight:
+        // Move piece right if possible
+        moved.x++;
+        if (isValidPosition(moved)) {
+            current = moved;
+            events |= EngineEvent::Move;
+            return true;
+        }
+        break;
+
+    case Action::SoftDrop:
+        // Soft drop - move piece down faster for small score bonus
+        moved.y++;
+        if (isValidPosition(moved)) {
+            current = moved;
+            score += 1;  // Small bonus for manual dropping
+            events |= EngineEvent::Move;
+            return true;
+        }
+        break;
+
+    case Action::Rotate:
+        // Rotate piece clockwise if possible - just the next entry of the rotation table
+        moved.rotation = (moved.rotation + 1) % PieceTable::ROTATION_COUNT;
+        if (isValidPosition(moved)) {
+            current = moved;
+            events |= EngineEvent::Rotate;
+            return true;
+        }
+        break;
+
+    case Action::HardDrop: {
+        // Hard drop - instantly drop piece to bottom
+        int distance = getTravelDistance(0, 1);
+        current.y += distance;
+        score += 2 * distance;  // Higher bonus for hard drop
+        events |= EngineEvent::Drop;
+        return true;
+    }
+
+    default:
+        break;
+    }
+    return false;
+}
+
+/**
+ * Step the piece until the next step would collide
+ */
+int TetrisEngine::getTravelDistance(int dx, int dy) const {
+    ActivePiece moved = current;
+    int distance = 0;
+    for (;;) {
+        moved.x += dx;
+        moved.y += dy;
+        if (!isValidPosition(moved)) return distance;
+        distance++;
+    }
+}
+
+/**
+ * Advance the simulation by one fixed tick
+ */
+void TetrisEngine::tick() {
+    tickCount++;
+
+    // Don't update game logic if game is over
+    if (gameOver) return;
+
+    // Check if it's time to drop the piece automatically
+    if (++dropCounter >= dropIntervalTicks) {
+        dropCounter = 0;
+        gravityStep();
+    }
+}
+
+/**
+ * Advance gravity by one row, locking the piece if it has landed
+ */
+void TetrisEngine::gravityStep() {
+    // Don't update game logic if game is over
+    if (gameOver) return;
+
+    ActivePiece fallen = current;
+    fallen.y++;
+
+    if (isValidPosition(fallen)) {
+        // Piece can fall further
+        current = fallen;
+    }
+    else {
+        // Piece has landed - place it, clear lines, and spawn new piece
+        placePiece();
+        clearLines();
+        spawnNewPiece();
+    }
+}
+
+/**
+ * Shift the stack up, fill the bottom rows and rehash the board
+ */
+void TetrisEngine::addGarbage(int count, int holeColumn) {
+    if (gameOver || count <= 0) return;
+    count = std::min(count, static_cast<int>(BOARD_HEIGHT));
+
+    // Settled blocks in the rows about to be pushed off the top end the game
+    bool toppedOut = false;
+    for (int y = 0; y < count; y++) {
+        if (rows[y] != 0) toppedOut = true;
+    }
+
+    std::memmove(rows, rows + count, (BOARD_HEIGHT - count) * sizeof(rows[0]));
+    std::memmove(colorPlane, colorPlane + count, (BOARD_HEIGHT - count) * sizeof(colorPlane[0]));
+    uint16_t garbageRow = static_cast<uint16_t>(FULL_ROW & ~(1u << holeColumn));
+    for (int y = BOARD_HEIGHT - count; y < BOARD_HEIGHT; y++) {
+        rows[y] = garbageRow;
+        for (int x = 0; x < BOARD_WIDTH; x++) {
+            colorPlane[y][x] = (garbageRow >> x) & 1 ? GARBAGE_COLOR : 0;
+        }
+    }
+    boardHash = Zobrist::hashRows(rows);
+
+    // Lift the falling piece out of the new blocks by at most the rows added. It may poke above
+    // the top like a fresh spawn (a valid position keeps a cell on the board), but it must stay
+    // inside the position range the hash keys and the search cover; otherwise it has topped out
+    ActivePiece lifted = current;
+    for (int i = 0; i < count && !isValidPosition(lifted); i++) {
+        lifted.y--;
+    }
+    if (isValidPosition(lifted) && lifted.y >= -Zobrist::POSITION_OFFSET) {
+        current = lifted;
+    }
+    else {
+        toppedOut = true;
+    }
+
+    if (toppedOut) {
+        gameOver = true;
+        events |= EngineEvent::GameOver;
+    }
+}
+
+/**
+ * Return pending events and clear them
+ */
+unsigned TetrisEngine::consumeEvents() {
+    unsigned pending = events;
+    events = 0;
+    return pending;
+}
+
+/**
+ * Spawn the next piece at the top of the board and draw a new next piece
+ */
+void TetrisEngine::spawnNewPiece() {
+    // Select random piece type (0-6) in its spawn orientation, positioned at
+    // top-center of board. Plain modulo rather than uniform_int_distribution,
+    // whose algorithm differs between standard libraries and would make
+    // replays platform dependent.
+    current.type = nextType;
+    nextType = static_cast<int>(rng() % PieceTable::PIECE_COUNT);
+    current.rotation = 0;
+    current.x = BOARD_WIDTH / 2 - 2;  // Center horizontally (accounting for 4-wide piece grid)
+    current.y = 0;                    // Start at top
+
+    // Check if spawn position is blocked (game over condition)
+    if (!isValidPosition(current)) {
+        gameOver = true;
+        events |= EngineEvent::GameOver;
+    }
+}
+
+/**
+ * Check if a piece can be placed at the specified position without collisions
+ */
+bool TetrisEngine::isValidPosition(const uint16_t boardRows[BOARD_HEIGHT], const ActivePiece& piece) {
+    const PieceShape& shape = PieceTable::shape(piece.type, piece.rotation);
+
+    // Check boundaries using the precomputed bounding box; cells may poke above the
+    // top, but a piece wholly above it would lock without leaving a block
+    if (piece.x + shape.minX < 0 || piece.x + shape.maxX >= BOARD_WIDTH ||   // Left/right boundaries
+        piece.y + shape.maxY >= BOARD_HEIGHT ||                              // Bottom boundary
+        piece.y + shape.maxY < 0) {                                          // At least one row on the board
+        return false;
+    }
+
+    // Check collisions with existing blocks, one occupied piece row at a time
+    for (int py = shape.minY; py <= shape.maxY; py++) {
+        int boardY = piece.y + py;
+        if (boardY < 0) continue;
+
+        // Bounds were checked above, so a negative x only shifts out empty columns
+        uint16_t rowMask = piece.x >= 0 ? shape.rows[py] << piece.x : shape.rows[py] >> -piece.x;
+        if (rowMask & boardRows[boardY]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Permanently place the current piece on the game board
+ */
+void TetrisEngine::placePiece() {
+    const PieceShape& shape = PieceTable::shape(current.type, current.rotation);
+    uint8_t color = static_cast<uint8_t>(current.type + 1);  // Color index 0 is empty
+
+    // Transfer each block of the current piece to the board
+    for (int py = shape.minY; py <= shape.maxY; py++) {
+        int boardY = current.y + py;
+
+        // Only place blocks that are within the visible board area
+        if (boardY < 0) continue;
+
+        for (int px = shape.minX; px <= shape.maxX; px++) {
+            if (shape.rows[py] & (1u << px)) {
+                int boardX = current.x + px;
+                rows[boardY] |= 1u << boardX;
+                colorPlane[boardY][boardX] = color;
+                boardHash ^= Zobrist::cellKey(boardY, boardX);
+            }
+        }
+    }
+
+    piecesPlaced++;
+    events |= EngineEvent::Drop;
+}
+
+/**
+ * Check for complete lines and clear them, updating score and level
+ */
+void TetrisEngine::clearLines() {
+    int previousLevel = level;
+
+    // Only rows covered by the piece that just locked can have become full
+    const PieceShape& shape = PieceTable::shape(current.type, current.rotation);
+    int top = std::max(0, current.y + shape.minY);
+    int bottom = current.y + shape.maxY;
+
+    uint32_t fullRows = 0;  // Bit (y - top) set for every full row
+    for (int y = top; y <= bottom; y++) {
+        if (rows[y] == FULL_ROW) {
+            fullRows |= 1u << (y - top);
+        }
+    }
+    if (fullRows == 0) return;
+
+    int clearedCount = static_cast<int>(std::bitset<4>(fullRows).count());
+
+    // Compact the surviving rows downwards in a single pass, starting at the
+    // lowest full row. Occupied rows always form a contiguous stack, so the
+    // scan can stop at the first empty row. Every rewritten row swaps its
+    // old key for its new one in the board hash.
+    int write = bottom;
+    while (!(fullRows & (1u << (write - top)))) write--;
+
+    int read = write;
+    for (; read >= 0 && rows[read] != 0; read--) {
+        if (read >= top && (fullRows & (1u << (read - top)))) continue;
+        boardHash ^= Zobrist::rowKey(write, rows[write]) ^ Zobrist::rowKey(write, rows[read]);
+        rows[write] = rows[read];
+        std::memcpy(colorPlane[write], colorPlane[read], sizeof(colorPlane[0]));
+        write--;
+    }
+
+    // Empty the rows vacated at the top of the stack
+    for (; write > read; write--) {
+        boardHash ^= Zobrist::rowKey(write, rows[write]);
+        rows[write] = 0;
+        std::memset(colorPlane[write], 0, sizeof(colorPlane[0]));
+    }
+
+    // Update score, level and speed
+    linesCleared += clearedCount;
+
+    // Score calculation: more lines cleared simultaneously = higher score multiplier
+    score += clearedCount * 100 * level;
+
+    // Level increases every 10 lines cleared
+    level = 1 + linesCleared / 10;
+
+    // Increase drop speed with level: 50ms (3 ticks) faster per level, minimum 50ms
+    dropIntervalTicks = std::max(MIN_DROP_TICKS, INITIAL_DROP_TICKS - (level - 1) * 3);
+
+    events |= EngineEvent::LineClear;
+    if (level > previousLevel) {
+        events |= EngineEvent::LevelUp;
+    }
+}
@@ -0,0 +1,244 @@
+#pragma once
+
+#include "PieceTable.h"
+#include "Zobrist.h"
+#include <random>
+#include <cstdint>
+
+/**
+ * @brief Player actions accepted by the simulation core
+ */
+enum class Action {
+    None,       ///< No input
+    MoveLeft,   ///< Shift the active piece one column left
+    MoveRight,  ///< Shift the active piece one column right
+    SoftDrop,   ///< Move the active piece one row down
+    Rotate,     ///< Rotate the active piece clockwise
+    HardDrop,   ///< Drop the active piece to its landing row
+    Restart     ///< Start a new game (only accepted after game over)
+};
+
+/**
+ * @brief Gameplay events raised by the engine
+ *
+ * Events are accumulated as bit flags and collected by the front end through
+ * TetrisEngine::consumeEvents(), which uses them to trigger sound effects.
+ */
+namespace EngineEvent {
+    enum : unsigned {
+        Move      = 1u << 0,    ///< Piece moved or soft dropped
+        Rotate    = 1u << 1,    ///< Piece rotated
+        Drop      = 1u << 2,    ///< Piece hard dropped or locked
+        LineClear = 1u << 3,    ///< One or more lines cleared
+        LevelUp   = 1u << 4,    ///< Level increased
+        GameOver  = 1u << 5     ///< Spawn position blocked
+    };
+}
+
+/**
+ * @brief Headless Tetris rules engine
+ *
+ * Owns the board, the active piece, scoring and the random piece sequence.
+ * It has no dependency on SFML so it can be driven by bots, simulations and
+ * validation tools without opening a window or an audio device. The Tetris
+ * class wraps an instance for display and input.
+ */
+class TetrisEngine {
+public:
+    // Game constants
+    static const int BOARD_WIDTH = 10;          ///< Width of the game board in blocks
+    static const int BOARD_HEIGHT = 20;         ///< Height of the game board in blocks
+    static const uint16_t FULL_ROW = (1u << BOARD_WIDTH) - 1;  ///< Row bitmask with every column occupied
+    static const int TICK_RATE = 60;            ///< Simulation ticks per second
+    static const int INITIAL_DROP_TICKS = 30;   ///< Ticks between automatic drops at level 1 (500ms)
+    static const int MIN_DROP_TICKS = 3;        ///< Fastest drop interval in ticks (50ms)
+    static const uint8_t GARBAGE_COLOR = PieceTable::PIECE_COUNT + 1;  ///< Color index of garbage cells (after the piece colors)
+
+    static_assert(BOARD_WIDTH == Zobrist::BOARD_WIDTH && BOARD_HEIGHT == Zobrist::BOARD_HEIGHT,
+                  "Zobrist keys must cover the whole board");
+
+    /**
+     * @brief Constructor - creates an empty board and spawns the first piece
+     *
+     * @param seed Seed for the piece sequence random number generator
+     *
+     * The same seed and the same actions on the same ticks always produce
+     * the same game, on every platform.
+     */
+    explicit TetrisEngine(uint32_t seed);
+
+    /**
+     * @brief Reset board, score and level and spawn a new piece
+     */
+    void reset();
+
+    /**
+     * @brief Apply a single player action
+     *
+     * @param action The action to apply
+     * @return true if the action changed the game state, false otherwise
+     *
+     * Movement actions are ignored once the game is over; Restart is only
+     * accepted after game over.
+     */
+    bool step(Action action);
+
+    /**
+     * @brief Advance the simulation by one fixed tick (1 / TICK_RATE seconds)
+     *
+     * Counts towards the next automatic drop and applies gravity once the
+     * level's drop interval has elapsed. The simulation only advances in
+     * whole ticks, so the same actions on the same ticks always produce the
+     * same game regardless of frame rate.
+     */
+    void tick();
+
+    /**
+     * @brief Advance gravity by one row immediately
+     *
+     * Moves the active piece down one row, or locks it, clears lines and
+     * spawns the next piece if it cannot fall further. Does nothing after
+     * game over. Bots use this to lock a hard-dropped piece without
+     * waiting for the drop interval.
+     */
+    void gravityStep();
+
+    /**
+     * @brief Push garbage rows in from the bottom of the board
+     *
+     * @param count Rows to add
+     * @param holeColumn The one empty column of every added row
+     *
+     * The stack moves up by count rows and the falling piece is lifted clear
+     * of it. The game ends if settled blocks are pushed off the top or the
+     * piece cannot be lifted clear. Versus play sends these to the opponent
+     * of a player who clears lines.
+     */
+    void addGarbage(int count, int holeColumn);
+
+    /**
+     * @brief Collect and clear the events raised since the last call
+     *
+     * @return Bitwise OR of EngineEvent flags
+     */
+    unsigned consumeEvents();
+
+    // State accessors
+    uint16_t getRow(int y) const { return rows[y]; }
+    const uint16_t* getRows() const { return rows; }
+    int getCell(int x, int y) const { return colorPlane[y][x]; }
+    const ActivePiece& getCurrentPiece() const { return current; }
+    int getNextType() const { return nextType; }
+    int getScore() const { return score; }
+    int getLevel() const { return level; }
+    int getLinesCleared() const { return linesCleared; }
+    int getPiecesPlaced() const { return piecesPlaced; }
+    bool isGameOver() const { return gameOver; }
+    int getDropIntervalTicks() const { return dropIntervalTicks; }
+    int getDropCounter() const { return dropCounter; }
+    uint64_t getTickCount() const { return tickCount; }
+    uint32_t getSeed() const { return seed; }
+
+    /**
+     * @brief Zobrist hash of the settled blocks only
+     *
+     * Maintained incrementally as pieces lock and lines clear. Colors are
+     * not part of the hash; two boards with the same occupancy hash equal.
+     */
+    uint64_t getBoardHash() const { return boardHash; }
+
+    /**
+     * @brief Zobrist hash of the board, the falling piece and the next piece
+     */
+    uint64_t getHash() const { return boardHash ^ Zobrist::activeKey(current) ^ Zobrist::nextKey(nextType); }
+
+    /**
+     * @brief Check if a piece can be placed at a specific position
+     *
+     * @param piece Piece type, rotation and position to check
+     * @return true if position is valid (no collisions), false otherwise
+     *
+     * Validates that the piece doesn't collide with board boundaries or existing blocks.
+     * Cells may be above the top, but at least one must be on the board.
+     * Walls are rejected from the shape's bounding box; only occupied piece rows
+     * are tested against the board row masks.
+     */
+    bool isValidPosition(const ActivePiece& piece) const { return isValidPosition(rows, piece); }
+
+    /**
+     * @brief Count how far the falling piece can travel in one direction
+     *
+     * @param dx Column step (-1, 0 or 1)
+     * @param dy Row step (0 or 1)
+     * @return Number of whole steps before the piece would collide
+     *
+     * This is the landing computation behind hard drops; the input layer
+     * also uses it to shift a piece straight to a wall or the floor.
+     */
+    int getTravelDistance(int dx, int dy) const;
+
+    /**
+     * @brief Check a piece position against an arbitrary board
+     *
+     * @param boardRows Row bitmasks of the board
+     * @param piece Piece type, rotation and position to check
+     * @return true if position is valid (no collisions), false otherwise
+     *
+     * Lets searches test positions on boards they built themselves.
+     */
+    static bool isValidPosition(const uint16_t boardRows[BOARD_HEIGHT], const ActivePiece& piece);
+
+private:
+    friend class EngineBenchmark;               ///< Times the private steps in isolation (TetrisBench.cpp)
+
+    // Game board representation
+    uint16_t rows[BOARD_HEIGHT];                ///< Occupancy bitmask per row (bit x set = column x filled)
+    uint8_t colorPlane[BOARD_HEIGHT][BOARD_WIDTH]; ///< Color index per cell (0 = empty), only read for rendering
+
+    // Current active piece state
+    ActivePiece current;                        ///< Type, rotation and position of the falling piece
+    int nextType;                               ///< Type of the piece that spawns after the current one
+
+    // Game state variables
+    int score;                                  ///< Current player score
+    int level;                                  ///< Current difficulty level
+    int linesCleared;                           ///< Total lines cleared (used for level calculation)
+    int piecesPlaced;                           ///< Pieces locked onto the board this game
+    bool gameOver;                              ///< Flag indicating if game has ended
+    int dropIntervalTicks;                      ///< Ticks between automatic drops (decreases with level)
+    int dropCounter;                            ///< Ticks elapsed since the last automatic drop
+    uint64_t tickCount;                         ///< Ticks simulated since construction
+    unsigned events;                            ///< Pending EngineEvent flags
+    uint64_t boardHash;                         ///< Zobrist hash of the settled blocks
+
+    // Random number generation
+    uint32_t seed;                              ///< Seed the piece sequence was started from
+    std::mt19937 rng;                           ///< Random number generator (output is fixed by the standard)
+
+    /**
+     * @brief Spawn the next piece at the top of the board
+     *
+     * Promotes the next piece to the current one, draws a new random next
+     * piece, positions it at the spawn location, and checks for game over
+     * condition if the spawn position is blocked.
+     */
+    void spawnNewPiece();
+
+    /**
+     * @brief Place the current piece permanently on the board
+     *
+     * Transfers the current piece from its temporary state to permanent
+     * positions on the game board grid, XORing each block's key into the
+     * board hash.
+     */
+    void placePiece();
+
+    /**
+     * @brief Check for and clear any complete horizontal lines
+     *
+     * Compares each row mask against FULL_ROW, shifts the rows above every
+     * full row down, and updates score and level. Only rows that are
+     * rewritten are rehashed.
+     */
+    void clearLines();
+};
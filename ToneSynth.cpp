@@ -0,0 +1,232 @@
+#include "ToneSynth.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define TETRIS_HAVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#define TETRIS_HAVE_AVX2 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    const int MAX_WIDTH = 8;                    // Widest vector, in samples; output is padded to a multiple
+    const size_t BLOCK_SAMPLES = 256;           // Samples between exact reseeds of the recurrences
+    const float TWO_PI = 6.28318530718f;
+
+    /**
+     * sin(2 pi x): reduce to [-1/2, 1/2] cycles, fold onto the quarter wave
+     * [0, 1/4] using sin(pi - y) = sin(y), then a Taylor polynomial to y^11
+     * (error below 6e-8 on the quarter wave) and put the sign back
+     */
+    template <typename Ops>
+    typename Ops::Vec sinCycles(typename Ops::Vec x) {
+        using Vec = typename Ops::Vec;
+
+        Vec reduced = Ops::sub(x, Ops::round(x));
+        Vec magnitude = Ops::abs(reduced);
+        magnitude = Ops::min(magnitude, Ops::sub(Ops::set(0.5f), magnitude));
+
+        Vec y = Ops::mul(magnitude, Ops::set(TWO_PI));
+        Vec y2 = Ops::mul(y, y);
+        Vec poly = Ops::set(-1.0f / 39916800.0f);
+        poly = Ops::add(Ops::mul(poly, y2), Ops::set(1.0f / 362880.0f));
+        poly = Ops::add(Ops::mul(poly, y2), Ops::set(-1.0f / 5040.0f));
+        poly = Ops::add(Ops::mul(poly, y2), Ops::set(1.0f / 120.0f));
+        poly = Ops::add(Ops::mul(poly, y2), Ops::set(-1.0f / 6.0f));
+        poly = Ops::add(Ops::mul(poly, y2), Ops::set(1.0f));
+        return Ops::copySign(Ops::mul(poly, y), reduced);
+    }
+
+    /**
+     * The kernel, Ops::WIDTH samples at a time; out must be padded to a multiple of the width
+     */
+    template <typename Ops>
+    void renderLanes(const ToneSpec& spec, unsigned sampleRate, int16_t* out, size_t count) {
+        using Vec = typename Ops::Vec;
+        const int width = Ops::WIDTH;
+        const double dt = 1.0 / sampleRate;
+
+        const Vec timeStep = Ops::set(static_cast<float>(width * dt));
+        const Vec envelopeStep = Ops::set(static_cast<float>(std::exp(-spec.decay * width * dt)));
+        const Vec pitchStep = Ops::set(static_cast<float>(std::exp(-spec.frequencyDecay * width * dt)));
+        const Vec sweep = Ops::set(spec.sweep);
+        const Vec partialScale = Ops::set(1.0f / spec.partialCount);
+
+        for (size_t blockStart = 0; blockStart < count; blockStart += BLOCK_SAMPLES) {
+            // Exact starting values for each lane of this block
+            alignas(32) float laneTime[MAX_WIDTH];
+            alignas(32) float laneEnvelope[MAX_WIDTH];
+            alignas(32) float lanePitch[MAX_WIDTH];
+            for (int lane = 0; lane < width; lane++) {
+                double t = (blockStart + lane) * dt;
+                laneTime[lane] = static_cast<float>(t);
+                laneEnvelope[lane] = static_cast<float>(spec.amplitude * std::exp(-spec.decay * t));
+                lanePitch[lane] = static_cast<float>(std::exp(-spec.frequencyDecay * t));
+            }
+            // Time is the block start plus a small offset, so adding up the steps loses no precision
+            Vec blockTime = Ops::load(laneTime);
+            Vec offset = Ops::set(0.0f);
+            Vec envelope = Ops::load(laneEnvelope);
+            Vec pitch = Ops::load(lanePitch);
+
+            size_t blockEnd = std::min(blockStart + BLOCK_SAMPLES, count);
+            for (size_t i = blockStart; i < blockEnd; i += width) {
+                Vec time = Ops::add(blockTime, offset);
+                Vec glide = Ops::mul(sweep, time);
+                Vec sum = Ops::set(0.0f);
+                for (int p = 0; p < spec.partialCount; p++) {
+                    Vec frequency = Ops::add(Ops::mul(Ops::set(spec.frequencies[p]), pitch), glide);
+                    sum = Ops::add(sum, sinCycles<Ops>(Ops::mul(frequency, time)));
+                }
+                Ops::storeSamples(out + i, Ops::mul(Ops::mul(sum, partialScale), envelope));
+
+                offset = Ops::add(offset, timeStep);
+                envelope = Ops::mul(envelope, envelopeStep);
+                pitch = Ops::mul(pitch, pitchStep);
+            }
+        }
+    }
+
+    /**
+     * Reference path: one float at a time through the same kernel
+     */
+    struct ScalarOps {
+        using Vec = float;
+        static const int WIDTH = 1;
+
+        static Vec load(const float* p) { return *p; }
+        static Vec set(float value) { return value; }
+        static Vec add(Vec a, Vec b) { return a + b; }
+        static Vec sub(Vec a, Vec b) { return a - b; }
+        static Vec mul(Vec a, Vec b) { return a * b; }
+        static Vec min(Vec a, Vec b) { return a < b ? a : b; }
+        static Vec abs(Vec v) { return std::fabs(v); }
+        static Vec round(Vec v) { return std::nearbyint(v); }
+        static Vec copySign(Vec magnitude, Vec sign) { return std::copysign(magnitude, sign); }
+        static void storeSamples(int16_t* p, Vec v) { *p = static_cast<int16_t>(v); }
+    };
+
+#ifdef TETRIS_HAVE_SSE2
+    /**
+     * 4 x float lanes in SSE2 registers
+     */
+    struct Sse2Ops {
+        using Vec = __m128;
+        static const int WIDTH = 4;
+
+        static Vec load(const float* p) { return _mm_load_ps(p); }
+        static Vec set(float value) { return _mm_set1_ps(value); }
+        static Vec add(Vec a, Vec b) { return _mm_add_ps(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm_sub_ps(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm_mul_ps(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm_min_ps(a, b); }
+        static Vec abs(Vec v) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), v); }
+        static Vec round(Vec v) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(v)); }
+        static Vec copySign(Vec magnitude, Vec sign) { return _mm_or_ps(magnitude, _mm_and_ps(sign, _mm_set1_ps(-0.0f))); }
+        static void storeSamples(int16_t* p, Vec v) {
+            __m128i words = _mm_cvttps_epi32(v);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(p), _mm_packs_epi32(words, words));
+        }
+    };
+#endif
+
+#ifdef TETRIS_HAVE_AVX2
+    /**
+     * 8 x float lanes in AVX2 registers
+     */
+    struct Avx2Ops {
+        using Vec = __m256;
+        static const int WIDTH = 8;
+
+        static Vec load(const float* p) { return _mm256_load_ps(p); }
+        static Vec set(float value) { return _mm256_set1_ps(value); }
+        static Vec add(Vec a, Vec b) { return _mm256_add_ps(a, b); }
+        static Vec sub(Vec a, Vec b) { return _mm256_sub_ps(a, b); }
+        static Vec mul(Vec a, Vec b) { return _mm256_mul_ps(a, b); }
+        static Vec min(Vec a, Vec b) { return _mm256_min_ps(a, b); }
+        static Vec abs(Vec v) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v); }
+        static Vec round(Vec v) { return _mm256_round_ps(v, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static Vec copySign(Vec magnitude, Vec sign) { return _mm256_or_ps(magnitude, _mm256_and_ps(sign, _mm256_set1_ps(-0.0f))); }
+        static void storeSamples(int16_t* p, Vec v) {
+            // Pack the two 128-bit halves so the samples stay in order
+            __m256i words = _mm256_cvttps_epi32(v);
+            __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(p), packed);
+        }
+    };
+#endif
+}
+
+/**
+ * Constructor - Use the requested backend if it was compiled in
+ */
+ToneSynth::ToneSynth(SynthBackend backend) :
+    backend(isAvailable(backend) ? backend : bestBackend())
+{
+}
+
+/**
+ * Dispatch to the selected backend over a buffer padded to the widest vector
+ */
+void ToneSynth::render(const ToneSpec& spec, unsigned sampleRate, std::vector<int16_t>& out) const {
+    size_t count = static_cast<size_t>(spec.seconds * sampleRate);
+    out.resize((count + MAX_WIDTH - 1) / MAX_WIDTH * MAX_WIDTH);
+
+    switch (backend) {
+#ifdef TETRIS_HAVE_AVX2
+    case SynthBackend::AVX2:
+        renderLanes<Avx2Ops>(spec, sampleRate, out.data(), count);
+        break;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+    case SynthBackend::SSE2:
+        renderLanes<Sse2Ops>(spec, sampleRate, out.data(), count);
+        break;
+#endif
+    default:
+        renderLanes<ScalarOps>(spec, sampleRate, out.data(), count);
+        break;
+    }
+
+    out.resize(count);
+}
+
+/**
+ * Report whether a backend was compiled in
+ */
+bool ToneSynth::isAvailable(SynthBackend backend) {
+    switch (backend) {
+#ifdef TETRIS_HAVE_AVX2
+    case SynthBackend::AVX2: return true;
+#endif
+#ifdef TETRIS_HAVE_SSE2
+    case SynthBackend::SSE2: return true;
+#endif
+    case SynthBackend::Scalar: return true;
+    default: return false;
+    }
+}
+
+/**
+ * Pick the widest backend compiled in
+ */
+SynthBackend ToneSynth::bestBackend() {
+    if (isAvailable(SynthBackend::AVX2)) return SynthBackend::AVX2;
+    if (isAvailable(SynthBackend::SSE2)) return SynthBackend::SSE2;
+    return SynthBackend::Scalar;
+}
+
+/**
+ * Backend display names
+ */
+const char* ToneSynth::backendName(SynthBackend backend) {
+    switch (backend) {
+    case SynthBackend::SSE2: return "SSE2";
+    case SynthBackend::AVX2: return "AVX2";
+    default: return "scalar";
+    }
+}
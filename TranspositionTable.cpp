@@ -0,0 +1,90 @@
+#include "TranspositionTable.h"
+#include <cstring>
+
+namespace {
+    const int DEPTH_SHIFT = 32;
+
+    uint64_t pack(int depth, float value) {
+        uint32_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return (static_cast<uint64_t>(depth & 0xFF) << DEPTH_SHIFT) | bits;
+    }
+
+    int unpackDepth(uint64_t data) {
+        return static_cast<int>((data >> DEPTH_SHIFT) & 0xFF);
+    }
+
+    float unpackValue(uint64_t data) {
+        uint32_t bits = static_cast<uint32_t>(data);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+}
+
+/**
+ * Constructor - Allocate the buckets and mark every entry empty
+ */
+TranspositionTable::TranspositionTable(int bucketBits) :
+    buckets(new Bucket[static_cast<size_t>(1) << bucketBits]),
+    mask((static_cast<uint64_t>(1) << bucketBits) - 1)
+{
+    clear();
+}
+
+/**
+ * Check the key's bucket for a matching, untorn entry
+ */
+bool TranspositionTable::probe(uint64_t key, float& value) const {
+    const Bucket& bucket = buckets[key & mask];
+    for (const Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+        // Depth 0 marks an empty entry
+        if ((check ^ data) == key && unpackDepth(data) != 0) {
+            value = unpackValue(data);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Overwrite the matching entry, or else the shallowest one
+ */
+void TranspositionTable::store(uint64_t key, int depth, float value) {
+    Bucket& bucket = buckets[key & mask];
+
+    Entry* victim = &bucket.entries[0];
+    int victimDepth = 256;
+    for (Entry& entry : bucket.entries) {
+        uint64_t data = entry.data.load(std::memory_order_relaxed);
+        uint64_t check = entry.check.load(std::memory_order_relaxed);
+
+        if ((check ^ data) == key) {
+            victim = &entry;
+            break;
+        }
+        if (unpackDepth(data) < victimDepth) {
+            victim = &entry;
+            victimDepth = unpackDepth(data);
+        }
+    }
+
+    uint64_t data = pack(depth, value);
+    victim->data.store(data, std::memory_order_relaxed);
+    victim->check.store(key ^ data, std::memory_order_relaxed);
+}
+
+/**
+ * Reset every entry to empty
+ */
+void TranspositionTable::clear() {
+    for (uint64_t i = 0; i <= mask; i++) {
+        for (Entry& entry : buckets[i].entries) {
+            entry.data.store(0, std::memory_order_relaxed);
+            entry.check.store(0, std::memory_order_relaxed);
+        }
+    }
+}
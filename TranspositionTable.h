@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+/**
+ * @brief Fixed-size cache of search results keyed by Zobrist hash
+ *
+ * Entries are grouped into buckets of four that fill exactly one 64-byte
+ * cache line, so a probe touches a single line. A store replaces the entry
+ * with the same key if there is one, otherwise the shallowest entry in the
+ * bucket: deep results cost the most to recompute and are kept longest.
+ *
+ * The table can be shared by any number of search threads without locks.
+ * Each entry is two relaxed atomics holding the data word and key ^ data;
+ * a torn read from a concurrent store fails the XOR check and is treated
+ * as a miss, never as a wrong hit.
+ */
+class TranspositionTable {
+public:
+    static const int BUCKET_SIZE = 4;           ///< Entries per cache line
+
+    /**
+     * @brief Constructor - allocates an empty table
+     *
+     * @param bucketBits Log2 of the number of buckets (16 = 4 MB, 262144 entries)
+     */
+    explicit TranspositionTable(int bucketBits = 16);
+
+    /**
+     * @brief Look up a stored value
+     *
+     * @param key Position key (the remaining depth must already be mixed in)
+     * @param value Receives the stored value on a hit
+     * @return true on a hit
+     */
+    bool probe(uint64_t key, float& value) const;
+
+    /**
+     * @brief Store a value, evicting the shallowest entry of the bucket if needed
+     *
+     * @param key Position key
+     * @param depth Remaining search depth the value was computed with (1-255)
+     * @param value Value to store
+     */
+    void store(uint64_t key, int depth, float value);
+
+    /**
+     * @brief Empty every entry (not safe while other threads are searching)
+     */
+    void clear();
+
+    size_t getCapacity() const { return (mask + 1) * BUCKET_SIZE; }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> check;            ///< key ^ data
+        std::atomic<uint64_t> data;             ///< Value bits (low 32) and depth (next 8)
+    };
+
+    struct alignas(64) Bucket {
+        Entry entries[BUCKET_SIZE];
+    };
+
+    static_assert(sizeof(Bucket) == 64, "a bucket must fill exactly one cache line");
+
+    std::unique_ptr<Bucket[]> buckets;          ///< Table storage
+    uint64_t mask;                              ///< Bucket count - 1
+};
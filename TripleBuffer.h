@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief Lock-free single-producer, single-consumer latest-value handoff
+ *
+ * Three copies of T: the writer fills its back buffer and publishes it by
+ * swapping it with the shared middle buffer; the reader picks up the middle
+ * buffer by swapping it with its front buffer. Neither side ever waits for
+ * the other, the writer can publish faster than the reader reads (the
+ * reader simply skips to the newest value), and a value being read is never
+ * written to.
+ *
+ * The middle buffer's index and a "fresh" bit share one atomic byte, so each
+ * handoff is a single exchange. The exchange's acquire/release ordering
+ * makes the writer's stores to a buffer visible before the reader sees it.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() :
+        slots(),
+        middle(1),
+        writeIndex(0),
+        readIndex(2)
+    {
+    }
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    /**
+     * @brief The writer's back buffer (writer thread only)
+     *
+     * It holds an older value, so the writer must overwrite all of it.
+     */
+    T& back() { return slots[writeIndex].value; }
+
+    /**
+     * @brief Hand the back buffer to the reader (writer thread only)
+     */
+    void publish() {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(writeIndex | FRESH), std::memory_order_acq_rel);
+        writeIndex = previous & INDEX_MASK;
+    }
+
+    /**
+     * @brief Switch to the newest published value if there is one (reader thread only)
+     *
+     * @return true if front() changed
+     */
+    bool acquire() {
+        if (!(middle.load(std::memory_order_relaxed) & FRESH)) return false;
+
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(readIndex), std::memory_order_acq_rel);
+        readIndex = previous & INDEX_MASK;
+        return true;
+    }
+
+    /**
+     * @brief The reader's current value (reader thread only)
+     */
+    const T& front() const { return slots[readIndex].value; }
+
+private:
+    static const uint8_t INDEX_MASK = 3;        ///< Low bits of middle: buffer index
+    static const uint8_t FRESH = 4;             ///< Set in middle when it holds an unread value
+
+    /**
+     * @brief One buffer, on its own cache lines so the threads never share one
+     */
+    struct alignas(64) Slot {
+        T value;
+    };
+
+    Slot slots[3];                              ///< The three buffers
+    alignas(64) std::atomic<uint8_t> middle;    ///< Index of the shared buffer, plus FRESH
+    alignas(64) int writeIndex;                 ///< Back buffer (writer's own)
+    alignas(64) int readIndex;                  ///< Front buffer (reader's own)
+};
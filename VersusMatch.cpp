@@ -0,0 +1,143 @@
+#include "VersusMatch.h"
+
+namespace {
+    const int GARBAGE_FOR_LINES[5] = { 0, 0, 1, 2, 4 };   // Rows sent per lines cleared at once
+    const uint32_t HOLE_SEED_SALT = 0x9E3779B9u;         // Keeps the hole sequence apart from the piece sequence
+
+    uint64_t rotateLeft(uint64_t value, int bits) {
+        return (value << bits) | (value >> (64 - bits));
+    }
+}
+
+/**
+ * Constructor - Both players start with no buttons held and nothing sent
+ */
+VersusMatch::VersusMatch(TetrisEngine& first, TetrisEngine& second, uint32_t seed,
+                         const InputSettings& firstSettings, const InputSettings& secondSettings) :
+    engines{ &first, &second },
+    inputs{ InputController(firstSettings), InputController(secondSettings) },
+    heldKeys(),
+    lastLinesCleared(),
+    garbageSent(),
+    holeRng(seed ^ HOLE_SEED_SALT),
+    tick(0)
+{
+}
+
+/**
+ * Buttons, then a tick for each player, then the garbage both of them earned this tick
+ */
+void VersusMatch::advance(const uint8_t keys[PLAYER_COUNT]) {
+    tick++;
+
+    if (isOver()) {
+        // Boards stay frozen on the result until someone asks for a rematch
+        const uint8_t restartBit = keyBit(InputKey::Restart);
+        bool rematch = false;
+        for (int player = 0; player < PLAYER_COUNT; player++) {
+            if ((keys[player] & restartBit) && !(heldKeys[player] & restartBit)) rematch = true;
+            heldKeys[player] = keys[player];
+        }
+        if (rematch) {
+            restart();
+        }
+        return;
+    }
+
+    for (int player = 0; player < PLAYER_COUNT; player++) {
+        applyKeys(player, keys[player]);
+        inputs[player].tick();
+        applyCommands(player);
+        engines[player]->tick();
+    }
+
+    int garbage[PLAYER_COUNT];
+    for (int player = 0; player < PLAYER_COUNT; player++) {
+        int lines = engines[player]->getLinesCleared() - lastLinesCleared[player];
+        lastLinesCleared[player] = engines[player]->getLinesCleared();
+        garbage[player] = GARBAGE_FOR_LINES[lines < 0 ? 0 : lines > 4 ? 4 : lines];
+        garbageSent[player] += garbage[player];
+    }
+    for (int player = 0; player < PLAYER_COUNT; player++) {
+        int incoming = garbage[PLAYER_COUNT - 1 - player];
+        if (incoming > 0) {
+            int hole = static_cast<int>(holeRng() % TetrisEngine::BOARD_WIDTH);
+            engines[player]->addGarbage(incoming, hole);
+        }
+    }
+}
+
+/**
+ * Press and release whatever changed since the previous tick
+ */
+void VersusMatch::applyKeys(int player, uint8_t keys) {
+    uint8_t changed = keys ^ heldKeys[player];
+    heldKeys[player] = keys;
+
+    for (int k = 0; k < InputController::KEY_COUNT; k++) {
+        InputKey key = static_cast<InputKey>(k);
+        if (!(changed & keyBit(key))) continue;
+
+        if (keys & keyBit(key)) {
+            inputs[player].press(key);
+        }
+        else {
+            inputs[player].release(key);
+        }
+        applyCommands(player);
+    }
+}
+
+/**
+ * Same resolution as the single player front end
+ */
+void VersusMatch::applyCommands(int player) {
+    TetrisEngine& engine = *engines[player];
+    InputCommand commands[InputController::MAX_COMMANDS];
+    int count = inputs[player].takeCommands(commands);
+
+    for (int i = 0; i < count; i++) {
+        Action action = commands[i].action;
+        int repeats = commands[i].count;
+        if (repeats == InputController::AS_FAR_AS_POSSIBLE) {
+            int dx = action == Action::MoveLeft ? -1 : action == Action::MoveRight ? 1 : 0;
+            int dy = action == Action::SoftDrop ? 1 : 0;
+            repeats = engine.isGameOver() ? 0 : engine.getTravelDistance(dx, dy);
+        }
+        for (int r = 0; r < repeats; r++) {
+            engine.step(action);
+        }
+    }
+}
+
+bool VersusMatch::isOver() const {
+    return engines[0]->isGameOver() || engines[1]->isGameOver();
+}
+
+int VersusMatch::getWinner() const {
+    if (engines[0]->isGameOver() == engines[1]->isGameOver()) return NO_WINNER;
+    return engines[0]->isGameOver() ? 1 : 0;
+}
+
+/**
+ * Mix both engines' hashes with their scores and line counts, plus the tick
+ */
+uint64_t VersusMatch::getHash() const {
+    uint64_t hash = tick;
+    for (int player = 0; player < PLAYER_COUNT; player++) {
+        const TetrisEngine& engine = *engines[player];
+        uint64_t playerHash = engine.getHash() ^ (static_cast<uint64_t>(engine.getScore()) << 32) ^
+                              static_cast<uint64_t>(engine.getLinesCleared());
+        hash = rotateLeft(hash, 17) ^ playerHash;
+    }
+    return hash;
+}
+
+void VersusMatch::restart() {
+    for (int player = 0; player < PLAYER_COUNT; player++) {
+        engines[player]->reset();
+        inputs[player].releaseAll();
+        lastLinesCleared[player] = 0;
+        garbageSent[player] = 0;
+    }
+}
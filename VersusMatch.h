@@ -0,0 +1,107 @@
+#pragma once
+
+#include "TetrisEngine.h"
+#include "InputController.h"
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief Deterministic two-player versus rules on top of two engines
+ *
+ * Each tick takes one byte of held buttons per player, runs it through that
+ * player's InputController (so auto-repeat behaves exactly as in single
+ * player) and ticks both engines. Clearing lines sends garbage rows to the
+ * opponent: 1 for a double, 2 for a triple and 4 for a Tetris, with one
+ * hole column shared by the rows of a batch.
+ *
+ * Everything depends only on the shared seed and the button bytes, so two
+ * peers that feed the same bytes to a match on each side stay identical
+ * tick for tick without ever sending board state. getHash() lets them
+ * check that they have.
+ *
+ * The engines belong to the caller and must both be freshly created with
+ * the seed passed here.
+ */
+class VersusMatch {
+public:
+    static const int PLAYER_COUNT = 2;          ///< Players in a match
+    static const int NO_WINNER = -1;            ///< getWinner() while playing or after a draw
+
+    /**
+     * @brief Constructor
+     *
+     * @param first Engine of player 0 (the host)
+     * @param second Engine of player 1
+     * @param seed Seed both engines were created with; also picks the garbage holes
+     * @param firstSettings Auto-repeat timing of player 0
+     * @param secondSettings Auto-repeat timing of player 1
+     */
+    VersusMatch(TetrisEngine& first, TetrisEngine& second, uint32_t seed,
+                const InputSettings& firstSettings, const InputSettings& secondSettings);
+
+    /**
+     * @brief Bit of an InputKey in a button byte
+     */
+    static uint8_t keyBit(InputKey key) { return static_cast<uint8_t>(1u << static_cast<int>(key)); }
+
+    /**
+     * @brief Run one tick for both players
+     *
+     * @param keys Held buttons of each player this tick (keyBit flags)
+     *
+     * Once the match is over the engines stop; a Restart press by either
+     * player then starts a new round on both boards.
+     */
+    void advance(const uint8_t keys[PLAYER_COUNT]);
+
+    /**
+     * @brief Ticks advanced since the match started
+     */
+    uint32_t getTick() const { return tick; }
+
+    /**
+     * @brief Whether a player has topped out
+     */
+    bool isOver() const;
+
+    /**
+     * @brief Player still standing once the match is over (NO_WINNER if both topped out on the same tick)
+     */
+    int getWinner() const;
+
+    /**
+     * @brief Garbage rows a player has sent this round
+     */
+    int getGarbageSent(int player) const { return garbageSent[player]; }
+
+    /**
+     * @brief Hash of both boards, falling pieces and the tick, for desync checks
+     */
+    uint64_t getHash() const;
+
+    const TetrisEngine& getEngine(int player) const { return *engines[player]; }
+
+private:
+    TetrisEngine* engines[PLAYER_COUNT];        ///< Boards of the two players
+    InputController inputs[PLAYER_COUNT];       ///< Auto-repeat of each player's buttons
+    uint8_t heldKeys[PLAYER_COUNT];             ///< Buttons held at the previous tick
+    int lastLinesCleared[PLAYER_COUNT];         ///< Engine line counts at the previous tick
+    int garbageSent[PLAYER_COUNT];              ///< Garbage rows sent this round
+    std::mt19937 holeRng;                       ///< Picks garbage hole columns (seeded from the shared seed)
+    uint32_t tick;                              ///< Ticks advanced
+
+    /**
+     * @brief Feed a player's button changes to their controller and apply the commands
+     */
+    void applyKeys(int player, uint8_t keys);
+
+    /**
+     * @brief Apply the commands a player's controller produced, resolving "as far as possible" with their engine
+     */
+    void applyCommands(int player);
+
+    /**
+     * @brief Clear both boards for a rematch
+     */
+    void restart();
+};
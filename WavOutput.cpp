@@ -0,0 +1,94 @@
+#include "WavOutput.h"
+#include <algorithm>
+
+namespace {
+    const uint16_t BITS_PER_SAMPLE = 16;
+    const uint16_t CHANNELS = 1;
+    const uint32_t HEADER_SIZE = 44;            // RIFF header, fmt chunk and data chunk header
+
+    void writeUint16(std::ofstream& out, uint16_t value) {
+        char bytes[2] = { static_cast<char>(value), static_cast<char>(value >> 8) };
+        out.write(bytes, 2);
+    }
+
+    void writeUint32(std::ofstream& out, uint32_t value) {
+        char bytes[4];
+        for (int i = 0; i < 4; i++) {
+            bytes[i] = static_cast<char>(value >> (i * 8));
+        }
+        out.write(bytes, 4);
+    }
+
+    /**
+     * Canonical 16-bit PCM header for `frames` mono samples
+     */
+    void writeHeader(std::ofstream& out, uint32_t frames) {
+        uint32_t dataSize = frames * CHANNELS * (BITS_PER_SAMPLE / 8);
+        out.write("RIFF", 4);
+        writeUint32(out, HEADER_SIZE - 8 + dataSize);
+        out.write("WAVE", 4);
+        out.write("fmt ", 4);
+        writeUint32(out, 16);
+        writeUint16(out, 1);  // PCM
+        writeUint16(out, CHANNELS);
+        writeUint32(out, SoundMixer::SAMPLE_RATE);
+        writeUint32(out, SoundMixer::SAMPLE_RATE * CHANNELS * (BITS_PER_SAMPLE / 8));
+        writeUint16(out, CHANNELS * (BITS_PER_SAMPLE / 8));
+        writeUint16(out, BITS_PER_SAMPLE);
+        out.write("data", 4);
+        writeUint32(out, dataSize);
+    }
+}
+
+/**
+ * Constructor - Size the block buffer; no file yet
+ */
+WavOutput::WavOutput(SoundMixer& mixer, int bufferFrames) :
+    mixer(mixer),
+    buffer(std::max(1, std::min(bufferFrames, static_cast<int>(SoundMixer::MAX_BLOCK_FRAMES)))),
+    frameCount(0)
+{
+}
+
+WavOutput::~WavOutput() {
+    close();
+}
+
+bool WavOutput::open(const std::string& path) {
+    close();
+    file.open(path, std::ios::binary | std::ios::trunc);
+    frameCount = 0;
+    if (!file) return false;
+
+    writeHeader(file, 0);
+    return static_cast<bool>(file);
+}
+
+/**
+ * Samples are written little-endian, as WAV requires
+ */
+bool WavOutput::pull(int blocks) {
+    if (!file.is_open()) return false;
+
+    for (int b = 0; b < blocks; b++) {
+        mixer.mix(buffer.data(), static_cast<int>(buffer.size()));
+        for (int16_t sample : buffer) {
+            writeUint16(file, static_cast<uint16_t>(sample));
+        }
+        frameCount += static_cast<uint32_t>(buffer.size());
+    }
+    return static_cast<bool>(file);
+}
+
+/**
+ * Rewrite the header now that the length is known
+ */
+bool WavOutput::close() {
+    if (!file.is_open()) return false;
+
+    file.seekp(0);
+    writeHeader(file, frameCount);
+    bool ok = static_cast<bool>(file);
+    file.close();
+    return ok;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include "SoundMixer.h"
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Null audio output: pulls a SoundMixer into a WAV file instead of a sound card
+ *
+ * Drives the mixer exactly like MixerStream does, one bufferFrames block
+ * per pull, but on the calling thread and as fast as it is asked to. Needs
+ * no audio device, so the mixer can be benchmarked and its output compared
+ * across builds on a headless machine.
+ */
+class WavOutput {
+public:
+    /**
+     * @brief Constructor
+     *
+     * @param mixer Mixer to pull from; must outlive the output
+     * @param bufferFrames Samples per pull, at most SoundMixer::MAX_BLOCK_FRAMES
+     */
+    WavOutput(SoundMixer& mixer, int bufferFrames);
+
+    /**
+     * @brief Finishes the file if it is still open
+     */
+    ~WavOutput();
+
+    WavOutput(const WavOutput&) = delete;
+    WavOutput& operator=(const WavOutput&) = delete;
+
+    /**
+     * @brief Create the file and write a header (sizes are filled in by close())
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Mix and write blocks
+     *
+     * @param blocks Number of bufferFrames blocks to pull
+     * @return false if the file is not open or a write failed
+     */
+    bool pull(int blocks = 1);
+
+    /**
+     * @brief Write the final sizes into the header and close the file
+     */
+    bool close();
+
+    /**
+     * @brief Samples written since open()
+     */
+    uint32_t getFrameCount() const { return frameCount; }
+
+private:
+    SoundMixer& mixer;                          ///< Source of the samples
+    std::vector<int16_t> buffer;                ///< One block (allocated once)
+    std::ofstream file;                         ///< Output, open between open() and close()
+    uint32_t frameCount;                        ///< Samples written so far
+};
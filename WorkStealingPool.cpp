@@ -0,0 +1,130 @@
+#include "WorkStealingPool.h"
+
+namespace {
+    thread_local const WorkStealingPool* currentPool = nullptr;  ///< Pool owning the calling thread, if any
+    thread_local int currentWorker = -1;                         ///< Worker index of the calling thread
+}
+
+/**
+ * Constructor - Create one deque and one thread per worker
+ */
+WorkStealingPool::WorkStealingPool(int threadCount) :
+    queuedTasks(0),
+    unfinishedTasks(0),
+    nextQueue(0),
+    stopping(false)
+{
+    if (threadCount <= 0) {
+        threadCount = static_cast<int>(std::thread::hardware_concurrency());
+        if (threadCount <= 0) threadCount = 1;
+    }
+
+    for (int i = 0; i < threadCount; i++) {
+        queues.emplace_back(new WorkerQueue());
+    }
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * Destructor - Drain remaining work, then stop and join every worker
+ */
+WorkStealingPool::~WorkStealingPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    workAvailable.notify_all();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+/**
+ * Push a task onto a worker deque and wake an idle worker
+ */
+void WorkStealingPool::submit(Task task) {
+    // Tasks spawned by a worker stay local; others are dealt round-robin
+    int target = (currentPool == this)
+        ? currentWorker
+        : static_cast<int>(nextQueue.fetch_add(1) % queues.size());
+
+    // Count the task before it becomes visible so the counters never underflow;
+    // the increment is made under sleepMutex so a worker about to sleep can't miss it
+    unfinishedTasks++;
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        queuedTasks++;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    workAvailable.notify_one();
+}
+
+/**
+ * Wait for the pool to become idle
+ */
+void WorkStealingPool::wait() {
+    std::unique_lock<std::mutex> lock(sleepMutex);
+    allDone.wait(lock, [this] { return unfinishedTasks == 0; });
+}
+
+/**
+ * Pop from the back of our own deque, else steal from the front of another
+ */
+bool WorkStealingPool::findTask(int worker, Task& task) {
+    {
+        WorkerQueue& own = *queues[worker];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // Steal the oldest task of the next non-empty victim
+    const int count = static_cast<int>(queues.size());
+    for (int offset = 1; offset < count; offset++) {
+        WorkerQueue& victim = *queues[(worker + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Run tasks until the pool stops, sleeping while there is nothing to do
+ */
+void WorkStealingPool::workerLoop(int worker) {
+    currentPool = this;
+    currentWorker = worker;
+
+    for (;;) {
+        Task task;
+        if (findTask(worker, task)) {
+            queuedTasks--;
+            task(worker);
+
+            if (--unfinishedTasks == 0) {
+                std::lock_guard<std::mutex> lock(sleepMutex);
+                allDone.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        workAvailable.wait(lock, [this] { return queuedTasks > 0 || stopping; });
+        if (stopping && queuedTasks == 0) return;
+    }
+}
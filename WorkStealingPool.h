@@ -0,0 +1,86 @@
+#pragma once
+
+#include <functional>
+#include <deque>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+
+/**
+ * @brief Fixed-size thread pool with per-worker task queues and work stealing
+ *
+ * Each worker owns a deque. Tasks submitted from outside the pool are dealt
+ * round-robin across the deques; tasks submitted from inside a task go to the
+ * submitting worker's own deque. A worker pops its newest task first and,
+ * when its deque is empty, steals the oldest task from another worker, so
+ * uneven task lengths still keep every core busy. Each deque has its own
+ * lock; there is no pool-wide queue lock on the task path.
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief A unit of work; receives the index of the worker running it
+     */
+    using Task = std::function<void(int worker)>;
+
+    /**
+     * @brief Constructor - starts the worker threads
+     *
+     * @param threadCount Number of workers (0 = one per hardware thread)
+     */
+    explicit WorkStealingPool(int threadCount = 0);
+
+    /**
+     * @brief Destructor - finishes queued tasks and joins the workers
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Queue a task for execution
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Block until every submitted task has finished
+     */
+    void wait();
+
+    int getThreadCount() const { return static_cast<int>(threads.size()); }
+
+private:
+    /**
+     * @brief One worker's deque, padded to its own cache line
+     */
+    struct alignas(64) WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;  ///< One deque per worker
+    std::vector<std::thread> threads;           ///< Worker threads
+
+    std::atomic<size_t> queuedTasks;            ///< Tasks sitting in some deque
+    std::atomic<size_t> unfinishedTasks;        ///< Tasks submitted but not yet completed
+    std::atomic<unsigned> nextQueue;            ///< Round-robin cursor for external submissions
+    std::atomic<bool> stopping;                 ///< Set when the pool is shutting down
+
+    std::mutex sleepMutex;                      ///< Guards sleeping and waking of idle workers and waiters
+    std::condition_variable workAvailable;      ///< Signalled when a task is queued or the pool stops
+    std::condition_variable allDone;            ///< Signalled when unfinishedTasks reaches zero
+
+    /**
+     * @brief Take a task from the worker's own deque, or steal one
+     */
+    bool findTask(int worker, Task& task);
+
+    /**
+     * @brief Worker thread body
+     */
+    void workerLoop(int worker);
+};
@@ -0,0 +1,147 @@
+#pragma once
+
+#include "PieceTable.h"
+#include <cstdint>
+
+/**
+ * @brief Zobrist keys for hashing boards and piece state
+ *
+ * Every board cell has a random 64-bit key and a board hashes to the XOR of
+ * the keys of its filled cells, so placing a block or moving a row only has
+ * to XOR the keys that changed. Row keys for whole 10-bit row masks are
+ * precomputed as two 5-bit halves, which lets line clears rehash a shifted
+ * row with two lookups instead of one per cell.
+ *
+ * Keys are generated at compile time with splitmix64 from a fixed seed, so
+ * hashes are identical across runs and platforms.
+ */
+namespace Zobrist {
+    constexpr int BOARD_WIDTH = 10;             ///< Must match TetrisEngine::BOARD_WIDTH
+    constexpr int BOARD_HEIGHT = 20;            ///< Must match TetrisEngine::BOARD_HEIGHT
+    constexpr int HALF_BITS = BOARD_WIDTH / 2;  ///< Columns per precomputed row half
+    constexpr int POSITION_OFFSET = 3;          ///< A piece's 4x4 grid can hang 3 cells off the left/top edge
+    constexpr int X_POSITIONS = BOARD_WIDTH + POSITION_OFFSET;
+    constexpr int Y_POSITIONS = BOARD_HEIGHT + POSITION_OFFSET;
+    constexpr int MAX_DEPTH = 16;               ///< Deepest search depth with its own key
+
+    /**
+     * @brief All keys, generated in one pass
+     */
+    struct KeySet {
+        uint64_t cells[BOARD_HEIGHT][BOARD_WIDTH];              ///< Filled cell (y, x)
+        uint64_t rowHalves[BOARD_HEIGHT][2][1 << HALF_BITS];    ///< XOR of the cells of every half-row mask
+        uint64_t rotations[PieceTable::PIECE_COUNT][PieceTable::ROTATION_COUNT];  ///< Active piece type and rotation
+        uint64_t columns[X_POSITIONS];                          ///< Active piece x position
+        uint64_t rows[Y_POSITIONS];                             ///< Active piece y position
+        uint64_t next[PieceTable::PIECE_COUNT];                 ///< Type of the upcoming piece
+        uint64_t depth[MAX_DEPTH + 1];                          ///< Remaining search depth
+    };
+
+    /**
+     * @brief Advance a splitmix64 state and return the next key
+     */
+    constexpr uint64_t splitmix64(uint64_t& state) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    constexpr KeySet buildKeys() {
+        KeySet keys = {};
+        uint64_t state = 0x7E7215ull;
+
+        for (int y = 0; y < BOARD_HEIGHT; y++) {
+            for (int x = 0; x < BOARD_WIDTH; x++) {
+                keys.cells[y][x] = splitmix64(state);
+            }
+
+            // Row half keys are derived from the cell keys, so hashing a row
+            // mask and hashing its cells one by one always agree
+            for (int half = 0; half < 2; half++) {
+                for (int mask = 0; mask < (1 << HALF_BITS); mask++) {
+                    uint64_t key = 0;
+                    for (int bit = 0; bit < HALF_BITS; bit++) {
+                        if (mask & (1 << bit)) key ^= keys.cells[y][half * HALF_BITS + bit];
+                    }
+                    keys.rowHalves[y][half][mask] = key;
+                }
+            }
+        }
+
+        for (int type = 0; type < PieceTable::PIECE_COUNT; type++) {
+            for (int rotation = 0; rotation < PieceTable::ROTATION_COUNT; rotation++) {
+                keys.rotations[type][rotation] = splitmix64(state);
+            }
+            keys.next[type] = splitmix64(state);
+        }
+        for (int x = 0; x < X_POSITIONS; x++) keys.columns[x] = splitmix64(state);
+        for (int y = 0; y < Y_POSITIONS; y++) keys.rows[y] = splitmix64(state);
+        for (int depth = 0; depth <= MAX_DEPTH; depth++) keys.depth[depth] = splitmix64(state);
+        return keys;
+    }
+
+    inline constexpr KeySet KEYS = buildKeys();  ///< Generated key tables
+
+    /**
+     * @brief Key of a single filled cell
+     */
+    constexpr uint64_t cellKey(int y, int x) {
+        return KEYS.cells[y][x];
+    }
+
+    /**
+     * @brief Combined key of every filled cell of row y
+     */
+    constexpr uint64_t rowKey(int y, uint16_t mask) {
+        return KEYS.rowHalves[y][0][mask & ((1 << HALF_BITS) - 1)] ^ KEYS.rowHalves[y][1][mask >> HALF_BITS];
+    }
+
+    /**
+     * @brief Key of the falling piece's type, rotation and position
+     */
+    constexpr uint64_t activeKey(const ActivePiece& piece) {
+        return KEYS.rotations[piece.type][piece.rotation] ^
+               KEYS.columns[piece.x + POSITION_OFFSET] ^
+               KEYS.rows[piece.y + POSITION_OFFSET];
+    }
+
+    /**
+     * @brief Key of the upcoming piece type
+     */
+    constexpr uint64_t nextKey(int type) {
+        return KEYS.next[type];
+    }
+
+    /**
+     * @brief Key of a remaining search depth
+     */
+    constexpr uint64_t depthKey(int depth) {
+        return KEYS.depth[depth];
+    }
+
+    /**
+     * @brief Hash a whole board from scratch
+     */
+    inline uint64_t hashRows(const uint16_t rows[BOARD_HEIGHT]) {
+        uint64_t hash = 0;
+        for (int y = 0; y < BOARD_HEIGHT; y++) {
+            hash ^= rowKey(y, rows[y]);
+        }
+        return hash;
+    }
+
+    /**
+     * @brief Update a board hash for the rows that differ between two boards
+     */
+    inline uint64_t rehashRows(uint64_t hash, const uint16_t before[BOARD_HEIGHT], const uint16_t after[BOARD_HEIGHT]) {
+        for (int y = 0; y < BOARD_HEIGHT; y++) {
+            if (before[y] != after[y]) {
+                hash ^= rowKey(y, before[y]) ^ rowKey(y, after[y]);
+            }
+        }
+        return hash;
+    }
+
+    static_assert(rowKey(0, 1u << 7) == cellKey(0, 7), "row keys must be the XOR of their cell keys");
+}